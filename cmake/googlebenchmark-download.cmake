@@ -0,0 +1,20 @@
+# same approach as googletest-download.cmake
+cmake_minimum_required(VERSION 3.5 FATAL_ERROR)
+
+project(googlebenchmark-download NONE)
+
+include(ExternalProject)
+
+ExternalProject_Add(
+  googlebenchmark
+  SOURCE_DIR "@GOOGLEBENCHMARK_DOWNLOAD_ROOT@/googlebenchmark-src"
+  BINARY_DIR "@GOOGLEBENCHMARK_DOWNLOAD_ROOT@/googlebenchmark-build"
+  GIT_REPOSITORY
+    https://github.com/google/benchmark.git
+  GIT_TAG
+    v1.5.2
+  CONFIGURE_COMMAND ""
+  BUILD_COMMAND ""
+  INSTALL_COMMAND ""
+  TEST_COMMAND ""
+  )
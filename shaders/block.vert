@@ -12,80 +12,64 @@
 #define BOT_RIGHT 2
 #define TOP_RIGHT 3
 
-layout (location = 0) in int cornerIndex;
+// Two triangles per face, indexed by gl_VertexIndex
+const int quadCorners[6] = int[](TOP_LEFT, BOT_LEFT, BOT_RIGHT, BOT_RIGHT, TOP_RIGHT, TOP_LEFT);
 
-layout (location = 1) in vec3 instancePos;
-layout (location = 2) in int instanceTexIndex;
-layout (location = 3) in int faceIndex;
+const vec2 cornerUVs[4] = vec2[](vec2(1, 0), vec2(0, 0), vec2(0, 1), vec2(1, 1));
 
-layout (std140, push_constant) uniform PushConsts 
+// Unit cube corners of every face, 4 per face in corner order
+const vec3 facePositions[24] = vec3[](
+    vec3(1, 1, 1), vec3(0, 1, 1), vec3(0, 0, 1), vec3(1, 0, 1), // FRONT
+    vec3(0, 1, 0), vec3(1, 1, 0), vec3(1, 0, 0), vec3(0, 0, 0), // BACK
+    vec3(0, 1, 1), vec3(0, 1, 0), vec3(0, 0, 0), vec3(0, 0, 1), // LEFT
+    vec3(1, 1, 0), vec3(1, 1, 1), vec3(1, 0, 1), vec3(1, 0, 0), // RIGHT
+    vec3(1, 1, 0), vec3(0, 1, 0), vec3(0, 1, 1), vec3(1, 1, 1), // TOP
+    vec3(1, 0, 1), vec3(0, 0, 1), vec3(0, 0, 0), vec3(1, 0, 0)  // BOTTOM
+);
+
+// Axes of the instance size the UVs of a face repeat along
+const ivec2 faceUVAxes[6] = ivec2[](
+    ivec2(0, 1), ivec2(0, 1), // FRONT, BACK
+    ivec2(2, 1), ivec2(2, 1), // LEFT, RIGHT
+    ivec2(0, 2), ivec2(0, 2)  // TOP, BOTTOM
+);
+
+// CubeInstance of the mesher, five words each: position xyz, texture index,
+// face in bits 0-7, (size - 1) per axis in bits 8-15, 16-23, 24-31
+#define INSTANCE_WORDS 5
+
+layout (std430, set = 1, binding = 0) readonly buffer Instances
+{
+    uint words[];
+} instances;
+
+layout (std140, push_constant) uniform PushConsts
 {
 	mat4 mvp;
 } pushConsts;
 
 layout (location = 0) out vec3 outUV;
 
-out gl_PerVertex 
+out gl_PerVertex
 {
     vec4 gl_Position;
 };
 
-void main() 
+void main()
 {
-    switch (cornerIndex)
-    {
-        case TOP_LEFT : outUV = vec3(vec2(1,0), instanceTexIndex); break;
-        case BOT_LEFT : outUV = vec3(vec2(0,0), instanceTexIndex); break;
-        case BOT_RIGHT: outUV = vec3(vec2(0,1), instanceTexIndex); break;
-        case TOP_RIGHT: outUV = vec3(vec2(1,1), instanceTexIndex); break;
-    }
-
-    vec3 pos;
-    switch (faceIndex)
-    {
-        case FRONT: switch (cornerIndex)
-        {
-            case TOP_LEFT : pos = vec3(1, 1, 1); break;
-            case BOT_LEFT : pos = vec3(0, 1, 1); break;
-            case BOT_RIGHT: pos = vec3(0, 0, 1); break;
-            case TOP_RIGHT: pos = vec3(1, 0, 1); break;
-        } break;
-        case BACK: switch (cornerIndex)
-        {
-            case TOP_LEFT : pos = vec3(0, 1, 0); break;
-            case BOT_LEFT : pos = vec3(1, 1, 0); break;
-            case BOT_RIGHT: pos = vec3(1, 0, 0); break;
-            case TOP_RIGHT: pos = vec3(0, 0, 0); break;
-        } break;
-        case LEFT: switch (cornerIndex)
-        {
-            case TOP_LEFT : pos = vec3(0, 1, 1); break;
-            case BOT_LEFT : pos = vec3(0, 1, 0); break;
-            case BOT_RIGHT: pos = vec3(0, 0, 0); break;
-            case TOP_RIGHT: pos = vec3(0, 0, 1); break;
-        } break;
-        case RIGHT: switch (cornerIndex)
-        {
-            case TOP_LEFT : pos = vec3(1, 1, 0); break;
-            case BOT_LEFT : pos = vec3(1, 1, 1); break;
-            case BOT_RIGHT: pos = vec3(1, 0, 1); break;
-            case TOP_RIGHT: pos = vec3(1, 0, 0); break;
-        } break;
-        case TOP: switch (cornerIndex)
-        {
-            case TOP_LEFT : pos = vec3(1, 1, 0); break;
-            case BOT_LEFT : pos = vec3(0, 1, 0); break;
-            case BOT_RIGHT: pos = vec3(0, 1, 1); break;
-            case TOP_RIGHT: pos = vec3(1, 1, 1); break;
-        } break;
-        case BOTTOM: switch (cornerIndex)
-        {
-            case TOP_LEFT : pos = vec3(1, 0, 1); break;
-            case BOT_LEFT : pos = vec3(0, 0, 1); break;
-            case BOT_RIGHT: pos = vec3(0, 0, 0); break;
-            case TOP_RIGHT: pos = vec3(1, 0, 0); break;
-        } break;
-    }
+    uint base = uint(gl_InstanceIndex) * INSTANCE_WORDS;
+    vec3 instancePos = uintBitsToFloat(uvec3(instances.words[base], instances.words[base + 1], instances.words[base + 2]));
+    uint instanceTexIndex = instances.words[base + 3];
+    uint faceData = instances.words[base + 4];
+
+    uint faceIndex = faceData & 0xFF;
+    vec3 size = vec3((faceData >> 8) & 0xFF, (faceData >> 16) & 0xFF, (faceData >> 24) & 0xFF) + 1.0;
+
+    int cornerIndex = quadCorners[gl_VertexIndex];
+    ivec2 uvAxes = faceUVAxes[faceIndex];
+    outUV = vec3(cornerUVs[cornerIndex] * vec2(size[uvAxes.x], size[uvAxes.y]), instanceTexIndex);
+
+    vec3 pos = facePositions[faceIndex * 4 + cornerIndex] * size;
 
     if (outUV.z > 12.5f)
 	{
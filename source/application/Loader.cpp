@@ -1,13 +1,106 @@
 #include <QImage>
 #include <QFile>
+#include <QSaveFile>
 
 #include <IFactory.h>
 #include <IResourceLoader.h>
+#include <MipChain.h>
+#include <Profiler.h>
 
+#include <cstring>
 #include <stdexcept>
 
 using Scene::TextureType;
 
+// Written on the first launch to the working directory
+static constexpr const char* g_texture_cache_path = "textures.cache";
+static constexpr uint32_t g_texture_cache_magic = 0x41545651u; // "QVTA"
+// Bump when the decoding or the colorization changes, the sources hash only covers the png files
+static constexpr uint32_t g_texture_cache_version = 2u;
+
+struct TextureCacheHeader
+{
+    uint32_t magic = g_texture_cache_magic;
+    uint32_t version = g_texture_cache_version;
+    uint64_t sources_hash = 0u;
+    uint32_t first = 0u;
+    uint32_t width = 0u;
+    uint32_t height = 0u;
+    uint32_t depth = 0u;
+    uint64_t data_size = 0u;
+};
+
+// Final RGBA layers of a texture array with their mip chains, mapped straight from the cache file
+class MappedTextureArray
+    : public Vulkan::IDataProvider
+{
+    QFile              file;
+    TextureCacheHeader header;
+    const uint8_t*     data = nullptr;
+
+public:
+    explicit MappedTextureArray(const QString& path)
+        : file(path)
+    {
+    }
+    ~MappedTextureArray() override = default;
+
+    // Null when the file is missing, truncated or was written for other sources
+    static std::unique_ptr<MappedTextureArray> Map(const QString& path, const TextureCacheHeader& expected)
+    {
+        auto res = std::make_unique<MappedTextureArray>(path);
+        if (!res->file.open(QIODevice::ReadOnly) || res->file.size() < static_cast<qint64>(sizeof(TextureCacheHeader)))
+            return nullptr;
+
+        auto mapped = res->file.map(0, res->file.size());
+        if (!mapped)
+            return nullptr;
+
+        auto& header = res->header;
+        memcpy(&header, mapped, sizeof(header));
+        if (header.magic != expected.magic || header.version != expected.version || header.sources_hash != expected.sources_hash
+            || header.first != expected.first || header.depth != expected.depth)
+            return nullptr;
+
+        if (header.data_size != Scene::GetMipChainSize(header.width, header.height, header.depth)
+            || res->file.size() != static_cast<qint64>(sizeof(header) + header.data_size))
+            return nullptr;
+
+        res->data = mapped + sizeof(header);
+        return res;
+    }
+
+    uint32_t GetWidth() const override
+    {
+        return header.width;
+    }
+
+    uint32_t GetHeight() const override
+    {
+        return header.height;
+    }
+
+    uint32_t GetDepth() const override
+    {
+        return header.depth;
+    }
+
+    uint32_t GetMipLevels() const override
+    {
+        return Scene::GetMipLevels(header.width, header.height);
+    }
+
+    const uint8_t* GetData() const override
+    {
+        return data;
+    }
+
+    uint32_t GetSize() const override
+    {
+        return static_cast<uint32_t>(header.data_size);
+    }
+};
+
 class Loader
     : public Scene::IResourceLoader
 {
@@ -66,6 +159,41 @@ class Loader
         }
     }
 
+    // FNV-1a over the png files of the layers
+    static uint64_t HashSources(TextureType first, uint32_t count)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            QFile file(GetTexturePath(static_cast<TextureType>(static_cast<uint32_t>(first) + i)));
+            if (!file.open(QIODevice::ReadOnly))
+                throw std::runtime_error("Cannot find the path specified: " + file.fileName().toStdString());
+
+            for (auto byte : file.readAll())
+            {
+                hash ^= static_cast<uint8_t>(byte);
+                hash *= 1099511628211ull;
+            }
+        }
+        return hash;
+    }
+
+    // A failed write only costs the decoding again on the next launch
+    static void WriteTextureCache(const QString& path, TextureCacheHeader header, const Vulkan::IDataProvider& data)
+    {
+        header.width = data.GetWidth();
+        header.height = data.GetHeight();
+        header.data_size = data.GetSize();
+
+        QSaveFile file(path);
+        if (!file.open(QIODevice::WriteOnly))
+            return;
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(data.GetData()), data.GetSize());
+        file.commit();
+    }
+
     static std::vector<uint8_t> GetShaderData(const QString& url)
     {
         QFile file(url);
@@ -83,6 +211,21 @@ public:
         return GetShaderData((":/" + GetShaderName(target) + "." + GetShaderTypeName(type) + ".spv").c_str());
     }
 
+    std::unique_ptr<Vulkan::IDataProvider> LoadTextureArray(TextureType first, uint32_t count) const override
+    {
+        PROFILE_ZONE("Loader::LoadTextureArray");
+        TextureCacheHeader expected;
+        expected.sources_hash = HashSources(first, count);
+        expected.first = static_cast<uint32_t>(first);
+        expected.depth = count;
+        if (auto cached = MappedTextureArray::Map(g_texture_cache_path, expected))
+            return cached;
+
+        auto decoded = Scene::DecodeTextureArray(first, count, *this);
+        WriteTextureCache(g_texture_cache_path, expected, *decoded);
+        return decoded;
+    }
+
     void LoadTexture(TextureType type, uint32_t& w, uint32_t& h, std::vector<uint8_t>& storage) const override
     {
         auto url = GetTexturePath(type);
@@ -2,10 +2,16 @@
 
 #include <IFactory.h>
 #include <ICamera.h>
+#include <CameraTrack.h>
 
 #include <IScene.h>
 #include <IResourceLoader.h>
 
+#include <Profiler.h>
+
+#include <chrono>
+#include <optional>
+
 #include "RenderInterface.h"
 
 std::unique_ptr<Scene::IResourceLoader> CreateLoader();
@@ -17,6 +23,14 @@ class VulkanRenderer
 
     std::unique_ptr<Vulkan::ICamera> camera;
     std::unique_ptr<Scene::IScene> scene;
+
+    // Written to and read from the working directory
+    static constexpr const char* track_path = "camera_track.txt";
+    static constexpr double playback_step = 1.0 / 60.0;
+
+    Vulkan::CameraRecorder recorder;
+    std::optional<Vulkan::CameraPlayer> player;
+    std::chrono::steady_clock::time_point playback_start;
 public:
     VulkanRenderer(QVulkanWindow& window)
         : m_window(window)
@@ -30,6 +44,7 @@ public:
 
     void initResources() override
     {
+        PROFILE_THREAD("Render");
         scene = Scene::IScene::Create(*camera, CreateFactory(m_window), CreateLoader());
     }
 
@@ -50,14 +65,75 @@ public:
 
     void startNextFrame() override
     {
+        if (player && !player->Step(*camera))
+            FinishPlayback();
+        recorder.OnFrame(*camera);
+
         scene->Render();
         m_window.setTitle(GetWindowTitle().c_str());
         m_window.frameReady();
         m_window.requestUpdate();
     }
 
+    // Written to the working directory, open with chrome://tracing or ui.perfetto.dev
+    void DumpTrace()
+    {
+        auto seconds = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        auto path = "trace_" + std::to_string(seconds) + ".json";
+        if (!Profiler::DumpChromeTrace(path))
+            qWarning("Failed to write %s", path.c_str());
+    }
+
+    void ToggleRecording()
+    {
+        if (!recorder.IsRecording())
+            return recorder.Start();
+
+        auto track = recorder.Stop();
+        if (!track.Save(track_path))
+            qWarning("Failed to write %s", track_path);
+    }
+
+    // Fixed time per frame, so every run shows the same frames whatever the frame rate
+    void StartPlayback()
+    {
+        Vulkan::CameraTrack track;
+        if (!track.Load(track_path))
+        {
+            qWarning("Failed to read %s", track_path);
+            return;
+        }
+
+        // Keys held down would keep moving the camera on top of the track
+        for (auto camera_key : { Vulkan::Key::W, Vulkan::Key::S, Vulkan::Key::A, Vulkan::Key::D, Vulkan::Key::Shift })
+            camera->OnKeyReleased(camera_key);
+
+        player.emplace(std::move(track), playback_step);
+        playback_start = std::chrono::steady_clock::now();
+    }
+
+    void FinishPlayback()
+    {
+        auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - playback_start).count();
+        auto frames = player->GetFrame();
+        qInfo("Camera track played: %llu frames in %.1f ms, %.3f ms per frame",
+            static_cast<unsigned long long>(frames), elapsed, frames ? elapsed / frames : 0.0);
+        player.reset();
+    }
+
     void OnKeyPressed(Qt::Key key) override
     {
+        switch (key)
+        {
+        case Qt::Key::Key_F9:    return ToggleRecording();
+        case Qt::Key::Key_F10:   return StartPlayback();
+        case Qt::Key::Key_F12:   return DumpTrace();
+        }
+
+        // The camera only follows the track while it plays
+        if (player)
+            return;
+
         switch (key)
         {
         case Qt::Key::Key_W:     return camera->OnKeyPressed(Vulkan::Key::W);
@@ -93,6 +169,10 @@ public:
         if (buttons & Qt::MouseButton::MiddleButton)
             buttons_flags |= Vulkan::MouseButtons::Middle;
 
+        // Still tracked during playback without buttons, so the view does not jump once it ends
+        if (player)
+            buttons_flags = 0u;
+
         camera->OnMouseMove(x, y, static_cast<Vulkan::MouseButtons>(buttons_flags));
     }
 };
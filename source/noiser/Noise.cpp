@@ -1,8 +1,6 @@
 #include <FastNoise.h>
 #include "Noise.h"
 
-#include <random>
-
 class Noise
     : public INoise
 {
@@ -11,10 +9,7 @@ class Noise
     FastNoise generator04;
 
     float amplitude = 0.f;
-
-    std::random_device random_devive;
-    mutable std::mt19937 generator;
-    std::uniform_int_distribution<> distribution{0, 256};
+    uint64_t seed = 0u;
 
 public:
     Noise(uint32_t seed, float amplitude)
@@ -22,7 +17,7 @@ public:
         , generator02(static_cast<int>(seed))
         , generator04(static_cast<int>(seed))
         , amplitude(amplitude)
-        , generator(seed)
+        , seed(seed)
     {
         generator01.SetFrequency(0.01f);
         generator02.SetFrequency(0.02f);
@@ -48,10 +43,14 @@ public:
         ));
     }
 
+    // Pure function of the position, so any thread may ask about any column
     bool IsTree(int32_t x, int32_t y) const override
     {
-        uint64_t val = static_cast<uint64_t>(distribution(generator)) * x;
-        val += static_cast<uint64_t>(distribution(generator)) * y;
+        uint64_t val = seed;
+        val ^= static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32 | static_cast<uint32_t>(y);
+        val = (val ^ (val >> 30)) * 0xbf58476d1ce4e5b9ull;
+        val = (val ^ (val >> 27)) * 0x94d049bb133111ebull;
+        val = val ^ (val >> 31);
         return (val % 128) == 0;
     }
 };
@@ -0,0 +1,240 @@
+#include "Profiler.h"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Profiler
+{
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+const Clock::time_point g_epoch = Clock::now();
+
+// Single producer ring, the owning thread writes and the dump reads. Slots are relaxed atomics,
+// the reader validates what it copied against the head afterwards instead of locking.
+class ThreadEvents
+{
+public:
+    static constexpr uint64_t capacity = 1u << 14u;
+
+    explicit ThreadEvents(uint32_t id)
+        : id(id)
+        , slots(capacity)
+    {
+    }
+
+    void Push(const ZoneEvent& event)
+    {
+        auto index = head.load(std::memory_order_relaxed);
+        auto& slot = slots[index % capacity];
+        // Pairs with the acquire fence of Read, a reader that sees any of the stores below
+        // also sees the head published before them and drops the slot as overwritten
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.name.store(event.name, std::memory_order_relaxed);
+        slot.begin.store(event.begin, std::memory_order_relaxed);
+        slot.end.store(event.end, std::memory_order_relaxed);
+        head.store(index + 1, std::memory_order_release);
+    }
+
+    std::vector<ZoneEvent> Read() const
+    {
+        auto last = head.load(std::memory_order_acquire);
+        auto first = last > capacity ? last - capacity : 0u;
+
+        std::vector<ZoneEvent> res;
+        res.reserve(last - first);
+        for (auto i = first; i < last; ++i)
+        {
+            const auto& slot = slots[i % capacity];
+            res.push_back({
+                slot.name.load(std::memory_order_relaxed),
+                slot.begin.load(std::memory_order_relaxed),
+                slot.end.load(std::memory_order_relaxed)
+            });
+        }
+
+        // Everything the writer could have reached while we were copying is unreliable,
+        // including the slot it may be writing right now without having published it yet
+        std::atomic_thread_fence(std::memory_order_acquire);
+        auto overwritten = head.load(std::memory_order_relaxed) + 1;
+        if (overwritten > capacity)
+        {
+            auto valid_from = overwritten - capacity;
+            if (valid_from > first)
+                res.erase(res.begin(), res.begin() + std::min(valid_from - first, static_cast<uint64_t>(res.size())));
+        }
+        return res;
+    }
+
+    const uint32_t id = 0u;
+
+    std::mutex  name_mutex;
+    std::string name;
+
+private:
+    struct Slot
+    {
+        std::atomic<const char*> name{ nullptr };
+        std::atomic<uint64_t>    begin{ 0u };
+        std::atomic<uint64_t>    end{ 0u };
+    };
+
+    std::vector<Slot>     slots;
+    std::atomic<uint64_t> head{ 0u };
+};
+
+// Buffers stay registered after their thread exits, so its events still make it to the dump.
+// The next new thread takes over the buffer of an exited one, short lived workers share a few lanes
+// instead of growing the registry without bound.
+struct Registry
+{
+    std::mutex                                 mutex;
+    std::vector<std::shared_ptr<ThreadEvents>> threads;
+    std::vector<std::shared_ptr<ThreadEvents>> released;
+
+    std::shared_ptr<ThreadEvents> Acquire()
+    {
+        std::lock_guard lock(mutex);
+        if (!released.empty())
+        {
+            auto res = std::move(released.back());
+            released.pop_back();
+            std::lock_guard name_lock(res->name_mutex);
+            res->name.clear();
+            return res;
+        }
+
+        threads.emplace_back(std::make_shared<ThreadEvents>(static_cast<uint32_t>(threads.size() + 1)));
+        return threads.back();
+    }
+
+    void Release(std::shared_ptr<ThreadEvents> events)
+    {
+        std::lock_guard lock(mutex);
+        released.push_back(std::move(events));
+    }
+
+    std::vector<std::shared_ptr<ThreadEvents>> Get()
+    {
+        std::lock_guard lock(mutex);
+        return threads;
+    }
+};
+
+Registry& GetRegistry()
+{
+    static Registry registry;
+    return registry;
+}
+
+// Hands the buffer back when its thread exits
+struct ThreadEventsOwner
+{
+    std::shared_ptr<ThreadEvents> events = GetRegistry().Acquire();
+
+    ~ThreadEventsOwner()
+    {
+        GetRegistry().Release(std::move(events));
+    }
+};
+
+ThreadEvents& GetThreadEvents()
+{
+    thread_local ThreadEventsOwner owner;
+    return *owner.events;
+}
+
+void WriteEscaped(std::ostream& out, const std::string& str)
+{
+    out << '"';
+    for (auto c : str)
+    {
+        if (c == '"' || c == '\\')
+            out << '\\' << c;
+        else if (static_cast<unsigned char>(c) < 0x20)
+            out << ' ';
+        else
+            out << c;
+    }
+    out << '"';
+}
+
+}
+
+uint64_t Now()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - g_epoch).count());
+}
+
+void Record(const ZoneEvent& event)
+{
+    GetThreadEvents().Push(event);
+}
+
+void SetThreadName(const std::string& name)
+{
+    auto& events = GetThreadEvents();
+    std::lock_guard lock(events.name_mutex);
+    events.name = name;
+}
+
+void WriteChromeTrace(std::ostream& out)
+{
+    auto flags = out.flags();
+    out << std::fixed;
+    out.precision(3);
+
+    out << "{\"traceEvents\":[";
+    bool first = true;
+    auto separator = [&]() {
+        if (!first)
+            out << ",\n";
+        first = false;
+    };
+
+    for (const auto& thread : GetRegistry().Get())
+    {
+        std::string name;
+        {
+            std::lock_guard lock(thread->name_mutex);
+            name = thread->name.empty() ? "Thread " + std::to_string(thread->id) : thread->name;
+        }
+        separator();
+        out << "{\"ph\":\"M\",\"pid\":1,\"tid\":" << thread->id << ",\"name\":\"thread_name\",\"args\":{\"name\":";
+        WriteEscaped(out, name);
+        out << "}}";
+
+        for (const auto& event : thread->Read())
+        {
+            if (!event.name || event.end < event.begin)
+                continue;
+
+            separator();
+            out << "{\"ph\":\"X\",\"pid\":1,\"tid\":" << thread->id << ",\"name\":";
+            WriteEscaped(out, event.name);
+            out << ",\"ts\":" << event.begin / 1000.0 << ",\"dur\":" << (event.end - event.begin) / 1000.0 << "}";
+        }
+    }
+    out << "],\"displayTimeUnit\":\"ms\"}\n";
+
+    out.flags(flags);
+}
+
+bool DumpChromeTrace(const std::string& path)
+{
+    std::ofstream out(path, std::ios::binary);
+    if (!out)
+        return false;
+
+    WriteChromeTrace(out);
+    return !!out;
+}
+
+}
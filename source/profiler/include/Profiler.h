@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace Profiler
+{
+
+// Zone names must outlive the profiler, string literals are expected
+struct ZoneEvent
+{
+    const char* name = nullptr;
+    uint64_t    begin = 0u; // nanoseconds since the profiler epoch
+    uint64_t    end = 0u;
+};
+
+uint64_t Now();
+
+// Appends to the ring buffer of the calling thread, the oldest events are overwritten when it's full
+void Record(const ZoneEvent& event);
+
+// Shown as the thread name in the trace, call once from the thread itself
+void SetThreadName(const std::string& name);
+
+// Chrome trace event format, readable by chrome://tracing and Perfetto.
+// Safe to call while other threads keep recording, events overwritten during the dump are dropped.
+void WriteChromeTrace(std::ostream& out);
+bool DumpChromeTrace(const std::string& path);
+
+class ScopeZone
+{
+public:
+    explicit ScopeZone(const char* name)
+        : name(name)
+        , begin(Now())
+    {
+    }
+
+    ~ScopeZone()
+    {
+        Record({ name, begin, Now() });
+    }
+
+    ScopeZone(const ScopeZone&) = delete;
+    ScopeZone& operator=(const ScopeZone&) = delete;
+
+private:
+    const char* name = nullptr;
+    uint64_t    begin = 0u;
+};
+
+}
+
+#ifdef PROFILER_ENABLED
+#define PROFILER_CONCAT_IMPL(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_IMPL(a, b)
+#define PROFILE_ZONE(name) ::Profiler::ScopeZone PROFILER_CONCAT(profile_zone_, __LINE__)(name)
+#define PROFILE_THREAD(name) ::Profiler::SetThreadName(name)
+#else
+#define PROFILE_ZONE(name)
+#define PROFILE_THREAD(name)
+#endif
@@ -0,0 +1,93 @@
+#include "gtest/gtest.h"
+
+#include <Profiler.h>
+
+#include <sstream>
+#include <thread>
+
+static size_t Count(const std::string& str, const std::string& what)
+{
+    size_t res = 0;
+    for (auto pos = str.find(what); pos != std::string::npos; pos = str.find(what, pos + what.size()))
+        ++res;
+    return res;
+}
+
+static std::string Dump()
+{
+    std::stringstream out;
+    Profiler::WriteChromeTrace(out);
+    return out.str();
+}
+
+TEST(ProfilerTests, ScopeZone)
+{
+    {
+        Profiler::ScopeZone zone("ProfilerTests.ScopeZone");
+    }
+
+    auto trace = Dump();
+    EXPECT_EQ(Count(trace, "\"name\":\"ProfilerTests.ScopeZone\""), 1u);
+    EXPECT_EQ(trace.front(), '{');
+    EXPECT_EQ(trace.substr(trace.size() - 2), "}\n");
+}
+
+TEST(ProfilerTests, ThreadName)
+{
+    std::thread([]() {
+        Profiler::SetThreadName("Worker \"1\"");
+        Profiler::ScopeZone zone("ProfilerTests.ThreadName");
+    }).join();
+
+    auto trace = Dump();
+    EXPECT_EQ(Count(trace, "\"name\":\"Worker \\\"1\\\"\""), 1u);
+    EXPECT_EQ(Count(trace, "ProfilerTests.ThreadName"), 1u);
+}
+
+TEST(ProfilerTests, OldestOverwritten)
+{
+    std::thread([]() {
+        Profiler::Record({ "ProfilerTests.Oldest", 1u, 2u });
+        for (int i = 0; i < 100000; ++i)
+            Profiler::Record({ "ProfilerTests.Newest", 3u, 4u });
+    }).join();
+
+    auto trace = Dump();
+    EXPECT_EQ(Count(trace, "ProfilerTests.Oldest"), 0u);
+    EXPECT_GT(Count(trace, "ProfilerTests.Newest"), 1000u);
+    EXPECT_LT(Count(trace, "ProfilerTests.Newest"), 100000u);
+}
+
+TEST(ProfilerTests, DumpWhileRecording)
+{
+    std::atomic_bool stop = false;
+    std::thread writer([&]() {
+        while (!stop)
+            Profiler::ScopeZone zone("ProfilerTests.Concurrent");
+    });
+
+    for (int i = 0; i < 3; ++i)
+    {
+        auto trace = Dump();
+        EXPECT_EQ(Count(trace, "\"ph\":\"X\""), Count(trace, "\"dur\":"));
+    }
+    stop = true;
+    writer.join();
+}
+
+TEST(ProfilerTests, ExitedThreadsAreReused)
+{
+    // Registers the buffer of this thread first
+    Profiler::ScopeZone zone("ProfilerTests.Reused");
+    auto before = Count(Dump(), "\"thread_name\"");
+    for (int i = 0; i < 100; ++i)
+    {
+        std::thread([]() {
+            Profiler::ScopeZone zone("ProfilerTests.ShortLived");
+        }).join();
+    }
+
+    auto trace = Dump();
+    EXPECT_LE(Count(trace, "\"thread_name\""), before + 1u);
+    EXPECT_EQ(Count(trace, "ProfilerTests.ShortLived"), 100u);
+}
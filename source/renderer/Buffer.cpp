@@ -1,9 +1,16 @@
+#include <Profiler.h>
+
 #include "Buffer.h"
 
-#include "ScopeCommandBuffer.h"
+#include "BufferRanges.h"
+#include "RetireQueue.h"
+#include "UploadBatch.h"
 #include "Common.h"
 #include "Utils.h"
 
+#include <algorithm>
+#include <stdexcept>
+
 namespace Vulkan
 {
 
@@ -97,6 +104,7 @@ VkBufferUsageFlags VkBufferUsage(BufferUsage usage)
     case BufferUsage::Index:    return VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
     case BufferUsage::Vertex:
     case BufferUsage::Instance: return VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+    case BufferUsage::Storage:  return VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
     default: throw std::logic_error("Wrong enum value");
     }
 }
@@ -104,6 +112,44 @@ VkBufferUsageFlags VkBufferUsage(BufferUsage usage)
 static constexpr uint32_t vertex_binding_index = 0;
 static constexpr uint32_t instance_binding_index = 1;
 
+StagingBuffer::StagingBuffer(uint32_t size, VulkanShared& vulkan)
+    : vulkan(vulkan)
+    , buffer(CreateBuffer(
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        size,
+        vulkan
+    ))
+{
+    void* data = nullptr;
+    VkResultSuccess(vkMapMemory(vulkan.device, buffer.memory, 0, buffer.size, 0, &data));
+    mapped = static_cast<uint8_t*>(data);
+}
+
+StagingBuffer::~StagingBuffer()
+{
+    vkUnmapMemory(vulkan.device, buffer.memory);
+    vulkan.upload_batch->Retire({ .buffer = buffer.buffer, .memory = buffer.memory });
+}
+
+std::span<uint8_t> StagingBuffer::GetData()
+{
+    return { mapped, buffer.size };
+}
+
+void StagingBuffer::Flush() const
+{
+    if (!buffer.flush)
+        return;
+
+    VkMappedMemoryRange mapped_range = {};
+    mapped_range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+    mapped_range.memory = buffer.memory;
+    mapped_range.offset = 0;
+    mapped_range.size = buffer.size;
+    VkResultSuccess(vkFlushMappedMemoryRanges(vulkan.device, 1, &mapped_range));
+}
+
 Buffer::Buffer(BufferUsage usage, const IDataProvider& data, VulkanShared& vulkan)
     : vulkan(vulkan)
     , usage(usage)
@@ -115,50 +161,96 @@ Buffer::Buffer(BufferUsage usage, const IDataProvider& data, VulkanShared& vulka
         vulkan
     ))
 {
+    if (usage == BufferUsage::Storage)
+        storage_descriptor = vulkan.storage_descriptors->Allocate(buffer.buffer);
     Update(data);
 }
 
+Buffer::Buffer(BufferUsage usage, const StagingBuffer& staging, uint32_t width, VulkanShared& vulkan)
+    : vulkan(vulkan)
+    , usage(usage)
+    , width(width)
+    , buffer(CreateBuffer(
+        VkBufferUsage(usage) | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        staging.GetSize(),
+        vulkan
+    ))
+{
+    if (usage == BufferUsage::Storage)
+        storage_descriptor = vulkan.storage_descriptors->Allocate(buffer.buffer);
+    Upload(staging);
+}
+
 Buffer::~Buffer()
 {
-    vkDestroyBuffer(vulkan.device, buffer.buffer, nullptr);
-    vkFreeMemory(vulkan.device, buffer.memory, nullptr);
+    vulkan.retire_queue->Retire({ .buffer = buffer.buffer, .memory = buffer.memory, .storage_descriptor = storage_descriptor });
 }
 
 void Buffer::Update(const IDataProvider& data)
 {
+    PROFILE_ZONE("Buffer::Update");
     if (!data.GetData())
         return;
 
-    auto upload = CreateBuffer(
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-        data.GetSize(),
-        vulkan
-    );
+    StagingBuffer upload(data.GetSize(), vulkan);
+    auto mapped = upload.GetData();
+    memcpy_s(mapped.data(), mapped.size(), data.GetData(), data.GetSize());
+    Upload(upload);
+}
 
-    void* mapped = nullptr;
-    VkResultSuccess(vkMapMemory(vulkan.device, upload.memory, 0, upload.size, 0, &mapped));
-    memcpy_s(mapped, upload.size, data.GetData(), data.GetSize());
-    if (upload.flush)
-    {
-        VkMappedMemoryRange mapped_range = {};
-        mapped_range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-        mapped_range.memory = upload.memory;
-        mapped_range.offset = 0;
-        mapped_range.size = upload.size;
-        VkResultSuccess(vkFlushMappedMemoryRanges(vulkan.device, 1, &mapped_range));
-    }
-    vkUnmapMemory(vulkan.device, upload.memory);
+void Buffer::Update(uint32_t offset, std::span<const uint8_t> data)
+{
+    const BufferRange range = { offset, data };
+    Update(std::span(&range, 1));
+}
+
+void Buffer::Update(std::span<const BufferRange> ranges)
+{
+    PROFILE_ZONE("Buffer::Update");
+    auto total_size = CheckBufferRanges(ranges, buffer.size);
+    if (total_size == 0u)
+        return;
 
+    // All ranges are packed into one staging buffer and copied by a single command, a region per range
+    StagingBuffer upload(total_size, vulkan);
+    auto mapped = upload.GetData();
+    std::vector<VkBufferCopy> regions;
+    regions.reserve(ranges.size());
+    VkDeviceSize staging_offset = 0u;
+    for (const auto& range : ranges)
     {
-        ScopeCommandBuffer scb(vulkan);
-        VkBufferCopy info = {};
-        info.size = data.GetSize();
-        scb.CopyBuffer(upload.buffer, buffer.buffer, info);
+        if (range.data.empty())
+            continue;
+
+        memcpy_s(mapped.data() + staging_offset, mapped.size() - staging_offset, range.data.data(), range.data.size());
+        regions.push_back({
+            .srcOffset = staging_offset,
+            .dstOffset = range.offset,
+            .size = range.data.size(),
+        });
+        staging_offset += range.data.size();
     }
+    upload.Flush();
+    vulkan.upload_batch->CopyBuffer(upload.GetBuffer(), buffer.buffer, regions);
+}
+
+void Buffer::Upload(const StagingBuffer& staging)
+{
+    PROFILE_ZONE("Buffer::Upload");
+    staging.Flush();
 
-    vkDestroyBuffer(vulkan.device, upload.buffer, nullptr);
-    vkFreeMemory(vulkan.device, upload.memory, nullptr);
+    VkBufferCopy info = {};
+    info.size = std::min(staging.GetSize(), buffer.size);
+    vulkan.upload_batch->CopyBuffer(staging.GetBuffer(), buffer.buffer, std::span(&info, 1));
+}
+
+void Buffer::BindStorage(VkCommandBuffer cmd_buf, VkPipelineLayout layout, uint32_t set) const
+{
+    if (usage != BufferUsage::Storage)
+        throw std::logic_error("Not a storage buffer");
+
+    vkCmdBindDescriptorSets(cmd_buf, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, set, 1, &storage_descriptor.set, 0, nullptr);
 }
 
 void Buffer::Bind(VkCommandBuffer cmd_buf) const
@@ -173,6 +265,8 @@ void Buffer::Bind(VkCommandBuffer cmd_buf) const
         return vkCmdBindVertexBuffers(cmd_buf, vertex_binding_index, 1, &buffer.buffer, offsets);
     case BufferUsage::Instance:
         return vkCmdBindVertexBuffers(cmd_buf, instance_binding_index, 1, &buffer.buffer, offsets);
+    case BufferUsage::Storage:
+        throw std::logic_error("Storage buffers are bound by the draw");
     default: throw std::logic_error("Wrong enum value");
     }
 }
@@ -241,6 +335,11 @@ IVertexBinding& VertexLayout::AddInstanceBinding()
     return bindings.back();
 }
 
+void VertexLayout::SetVertexCount(uint32_t count)
+{
+    vertex_count = count;
+}
+
 VertexLayoutData VertexLayout::GetData() const
 {
     VertexLayoutData layout_data;
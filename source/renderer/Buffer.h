@@ -3,6 +3,7 @@
 #include <vulkan/vulkan.h>
 #include "IRenderer.h"
 #include "IFactory.h"
+#include "DescriptorSet.h"
 
 #include <vector>
 #include <deque>
@@ -55,11 +56,38 @@ struct VertexLayout
     ~VertexLayout() override = default;
     IVertexBinding& AddVertexBinding() override;
     IVertexBinding& AddInstanceBinding() override;
+    void SetVertexCount(uint32_t count) override;
 
     VertexLayoutData GetData() const;
+    uint32_t GetVertexCount() const { return vertex_count; }
 
 private:
     std::deque<VertexBinding> bindings;
+    uint32_t                  vertex_count = 0u;
+};
+
+// Host visible buffer that stays mapped until it is destroyed. The destruction goes through the upload batch,
+// so it may be dropped as soon as its copies are recorded into it.
+class StagingBuffer
+    : public IStagingBuffer
+{
+public:
+    StagingBuffer(uint32_t size, VulkanShared& vulkan);
+    ~StagingBuffer() override;
+
+    std::span<uint8_t> GetData() override;
+
+    // Makes the host writes visible to the device
+    void Flush() const;
+
+    VkBuffer GetBuffer() const { return buffer.buffer; }
+    uint32_t GetSize() const { return buffer.size; }
+
+private:
+    VulkanShared& vulkan;
+
+    BufferDesc buffer{};
+    uint8_t*   mapped = nullptr;
 };
 
 class Buffer
@@ -67,21 +95,30 @@ class Buffer
 {
 public:
     Buffer(BufferUsage usage, const IDataProvider& data, VulkanShared& vulkan);
+    Buffer(BufferUsage usage, const StagingBuffer& staging, uint32_t width, VulkanShared& vulkan);
     ~Buffer() override;
 
     void Update(const IDataProvider&) override;
+    void Update(uint32_t offset, std::span<const uint8_t> data) override;
+    void Update(std::span<const BufferRange> ranges) override;
 
     void Bind(VkCommandBuffer cmd_buf) const;
+    // Storage buffers only, binds the whole buffer as the given set of the layout
+    void BindStorage(VkCommandBuffer cmd_buf, VkPipelineLayout layout, uint32_t set) const;
 
     uint32_t GetWidth() const { return width; }
     BufferUsage GetUsage() const { return usage; }
 
 protected:
+    void Upload(const StagingBuffer& staging);
+
     VulkanShared& vulkan;
 
     uint32_t    width = 0u;
     BufferUsage usage{};
     BufferDesc  buffer{};
+
+    StorageDescriptor storage_descriptor{};
 };
 
 }
\ No newline at end of file
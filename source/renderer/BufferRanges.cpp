@@ -0,0 +1,37 @@
+#include "BufferRanges.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace Vulkan
+{
+
+uint32_t CheckBufferRanges(std::span<const BufferRange> ranges, uint32_t buffer_size)
+{
+    uint64_t total_size = 0u;
+    std::vector<BufferRange> sorted;
+    sorted.reserve(ranges.size());
+    for (const auto& range : ranges)
+    {
+        if (static_cast<uint64_t>(range.offset) + range.data.size() > buffer_size)
+            throw std::out_of_range("Buffer range is out of bounds");
+        if (range.data.empty())
+            continue;
+
+        total_size += range.data.size();
+        sorted.push_back(range);
+    }
+
+    std::sort(sorted.begin(), sorted.end(), [](const BufferRange& l, const BufferRange& r) {
+        return l.offset < r.offset;
+    });
+    for (size_t i = 1; i < sorted.size(); ++i)
+    {
+        if (sorted[i - 1].offset + sorted[i - 1].data.size() > sorted[i].offset)
+            throw std::invalid_argument("Buffer ranges overlap");
+    }
+    return static_cast<uint32_t>(total_size);
+}
+
+}
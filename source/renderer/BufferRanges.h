@@ -0,0 +1,9 @@
+#pragma once
+
+#include "IRenderer.h"
+
+namespace Vulkan
+{
+    // Total bytes of the ranges. Throws when a range ends past buffer_size or two ranges overlap.
+    uint32_t CheckBufferRanges(std::span<const BufferRange> ranges, uint32_t buffer_size);
+}
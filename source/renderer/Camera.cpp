@@ -1,111 +1,151 @@
-#include <QMatrix4x4>
-#include <QVector2D>
-#include <qmath.h>
+#include <algorithm>
 #include <array>
+#include <chrono>
+#include <cmath>
+#include <numbers>
+#include <string>
 
 #include "Camera.h"
+#include "FrustumCulling.h"
 
-class AAbox
+struct Vector3
 {
-    const Vulkan::BBox& bbox;
-public:
-    AAbox(const Vulkan::BBox& bbox)
-        : bbox(bbox)
-    {
-    }
+    float x = 0.f;
+    float y = 0.f;
+    float z = 0.f;
+
+    float& operator[](size_t i) { return i == 0 ? x : i == 1 ? y : z; }
+    float operator[](size_t i) const { return i == 0 ? x : i == 1 ? y : z; }
+
+    Vector3& operator+=(const Vector3& v) { x += v.x; y += v.y; z += v.z; return *this; }
+    Vector3& operator-=(const Vector3& v) { x -= v.x; y -= v.y; z -= v.z; return *this; }
+
+    friend Vector3 operator*(const Vector3& v, float s) { return { v.x * s, v.y * s, v.z * s }; }
 
-    QVector3D GetPositive(const QVector4D& normal) const
+    static Vector3 crossProduct(const Vector3& a, const Vector3& b)
     {
-        QVector3D p(bbox.min_x, bbox.min_y, bbox.min_z);
-        if (normal.x() >= 0)
-            p.setX(bbox.max_x);
-        if (normal.y() >= 0)
-            p.setY(bbox.max_y);
-        if (normal.z() >= 0)
-            p.setZ(bbox.max_z);
-        return p;
+        return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
     }
 
-    QVector3D GetNegative(const QVector4D& normal) const
+    Vector3 normalized() const
     {
-        QVector3D p(bbox.max_x, bbox.max_y, bbox.max_z);
-        if (normal.x() >= 0)
-            p.setX(bbox.min_x);
-        if (normal.y() >= 0)
-            p.setY(bbox.min_y);
-        if (normal.z() >= 0)
-            p.setZ(bbox.min_z);
-        return p;
+        float len = std::sqrt(x * x + y * y + z * z);
+        return len > 0.f ? *this * (1.f / len) : *this;
     }
 };
 
-class Frustum
+// Column major, the layout pushed to the shaders. Every transform multiplies on the right.
+struct Matrix4
 {
-public:
-    enum side { LEFT = 0, RIGHT = 1, TOP = 2, BOTTOM = 3, BACK = 4, FRONT = 5 };
-    std::array<QVector4D, 6> planes;
+    std::array<float, 16> data = {
+        1.f, 0.f, 0.f, 0.f,
+        0.f, 1.f, 0.f, 0.f,
+        0.f, 0.f, 1.f, 0.f,
+        0.f, 0.f, 0.f, 1.f,
+    };
+
+    float& operator()(size_t row, size_t column) { return data[column * 4 + row]; }
+    float operator()(size_t row, size_t column) const { return data[column * 4 + row]; }
 
-    void update(const QMatrix4x4& model)
+    friend Matrix4 operator*(const Matrix4& a, const Matrix4& b)
     {
-        std::array<QVector4D, 4> matrix = {
-            model.column(0),
-            model.column(1),
-            model.column(2),
-            model.column(3),
-        };
-        planes[LEFT].setX(matrix[0].w() + matrix[0].x());
-        planes[LEFT].setY(matrix[1].w() + matrix[1].x());
-        planes[LEFT].setZ(matrix[2].w() + matrix[2].x());
-        planes[LEFT].setW(matrix[3].w() + matrix[3].x());
-
-        planes[RIGHT].setX(matrix[0].w() - matrix[0].x());
-        planes[RIGHT].setY(matrix[1].w() - matrix[1].x());
-        planes[RIGHT].setZ(matrix[2].w() - matrix[2].x());
-        planes[RIGHT].setW(matrix[3].w() - matrix[3].x());
-
-        planes[TOP].setX(matrix[0].w() - matrix[0].y());
-        planes[TOP].setY(matrix[1].w() - matrix[1].y());
-        planes[TOP].setZ(matrix[2].w() - matrix[2].y());
-        planes[TOP].setW(matrix[3].w() - matrix[3].y());
-
-        planes[BOTTOM].setX(matrix[0].w() + matrix[0].y());
-        planes[BOTTOM].setY(matrix[1].w() + matrix[1].y());
-        planes[BOTTOM].setZ(matrix[2].w() + matrix[2].y());
-        planes[BOTTOM].setW(matrix[3].w() + matrix[3].y());
-
-        planes[BACK].setX(matrix[0].w() + matrix[0].z());
-        planes[BACK].setY(matrix[1].w() + matrix[1].z());
-        planes[BACK].setZ(matrix[2].w() + matrix[2].z());
-        planes[BACK].setW(matrix[3].w() + matrix[3].z());
-
-        planes[FRONT].setX(matrix[0].w() - matrix[0].z());
-        planes[FRONT].setY(matrix[1].w() - matrix[1].z());
-        planes[FRONT].setZ(matrix[2].w() - matrix[2].z());
-        planes[FRONT].setW(matrix[3].w() - matrix[3].z());
-
-        for (auto i = 0; i < planes.size(); i++)
+        Matrix4 res;
+        for (size_t row = 0; row < 4; ++row)
         {
-            planes[i].normalize();
+            for (size_t column = 0; column < 4; ++column)
+            {
+                float sum = 0.f;
+                for (size_t i = 0; i < 4; ++i)
+                    sum += a(row, i) * b(i, column);
+                res(row, column) = sum;
+            }
         }
+        return res;
     }
 
-    static float distance(const QVector4D& plane, const QVector3D& pos)
+    // Counterclockwise around a unit axis
+    void rotate(float degrees, const Vector3& axis)
     {
-        return plane.x() * pos.x() + plane.y() * pos.y() + plane.z() * pos.z() + plane.w();
+        float radians = degrees * std::numbers::pi_v<float> / 180.f;
+        float c = std::cos(radians);
+        float s = std::sin(radians);
+        float t = 1.f - c;
+
+        Matrix4 rotation;
+        rotation(0, 0) = axis.x * axis.x * t + c;
+        rotation(0, 1) = axis.x * axis.y * t - axis.z * s;
+        rotation(0, 2) = axis.x * axis.z * t + axis.y * s;
+        rotation(1, 0) = axis.y * axis.x * t + axis.z * s;
+        rotation(1, 1) = axis.y * axis.y * t + c;
+        rotation(1, 2) = axis.y * axis.z * t - axis.x * s;
+        rotation(2, 0) = axis.z * axis.x * t - axis.y * s;
+        rotation(2, 1) = axis.z * axis.y * t + axis.x * s;
+        rotation(2, 2) = axis.z * axis.z * t + c;
+        *this = *this * rotation;
     }
 
-    bool checkBox(const AAbox& box) const
+    void translate(const Vector3& v)
     {
-        for (auto i = 0; i < planes.size(); i++)
-        {
-            if (distance(planes[i], box.GetPositive(planes[i])) <= 0)
-                return false;
+        Matrix4 translation;
+        translation(0, 3) = v.x;
+        translation(1, 3) = v.y;
+        translation(2, 3) = v.z;
+        *this = *this * translation;
+    }
+
+    // Right handed, depth from -1 to 1, fov in degrees along y
+    void perspective(float fov, float aspect, float znear, float zfar)
+    {
+        float half = fov * std::numbers::pi_v<float> / 360.f;
+        float sine = std::sin(half);
+        if (sine == 0.f || aspect == 0.f || znear == zfar)
+            return;
+
+        float cotan = std::cos(half) / sine;
+        float clip = zfar - znear;
+
+        Matrix4 projection;
+        projection(0, 0) = cotan / aspect;
+        projection(1, 1) = cotan;
+        projection(2, 2) = -(znear + zfar) / clip;
+        projection(2, 3) = -(2.f * znear * zfar) / clip;
+        projection(3, 2) = -1.f;
+        projection(3, 3) = 0.f;
+        *this = *this * projection;
+    }
+};
+
+class Frustum
+{
+public:
+    enum side { LEFT = 0, RIGHT = 1, TOP = 2, BOTTOM = 3, BACK = 4, FRONT = 5 };
+    Vulkan::FrustumPlanes culling_planes;
 
-            // Intersection check
-            // else if (distance(planes[i], box.GetNegative(planes[i])) <= 0)
-            //     return true;
+    void update(const Matrix4& model)
+    {
+        // Row 3 plus or minus rows 0, 1 and 2 of the view projection
+        auto plane = [&](size_t row, float sign) -> Vulkan::Plane {
+            return {
+                model(3, 0) + sign * model(row, 0),
+                model(3, 1) + sign * model(row, 1),
+                model(3, 2) + sign * model(row, 2),
+                model(3, 3) + sign * model(row, 3),
+            };
+        };
+        culling_planes[LEFT] = plane(0, 1.f);
+        culling_planes[RIGHT] = plane(0, -1.f);
+        culling_planes[TOP] = plane(1, -1.f);
+        culling_planes[BOTTOM] = plane(1, 1.f);
+        culling_planes[BACK] = plane(2, 1.f);
+        culling_planes[FRONT] = plane(2, -1.f);
+
+        // Scaled by the length of all four components, only the sign of a distance is used
+        for (auto& p : culling_planes)
+        {
+            float len = std::sqrt(p.x * p.x + p.y * p.y + p.z * p.z + p.w * p.w);
+            if (len > 0.f)
+                p = { p.x / len, p.y / len, p.z / len, p.w / len };
         }
-        return true;
     }
 };
 
@@ -117,14 +157,14 @@ private:
 
     void updateViewMatrix()
     {
-        QMatrix4x4 rotM;
-        QMatrix4x4 transM;
+        Matrix4 rotM;
+        Matrix4 transM;
 
-        rotM.rotate(rotation[0] * (flipY ? -1.0f : 1.0f), QVector3D(1.0f, 0.0f, 0.0f));
-        rotM.rotate(rotation[1], QVector3D(0.0f, 1.0f, 0.0f));
-        rotM.rotate(rotation[2], QVector3D(0.0f, 0.0f, 1.0f));
+        rotM.rotate(rotation[0] * (flipY ? -1.0f : 1.0f), Vector3{ 1.0f, 0.0f, 0.0f });
+        rotM.rotate(rotation[1], Vector3{ 0.0f, 1.0f, 0.0f });
+        rotM.rotate(rotation[2], Vector3{ 0.0f, 0.0f, 1.0f });
 
-        QVector3D translation = position;
+        Vector3 translation = position;
         if (flipY)
         {
             translation[1] *= -1.0f;
@@ -140,7 +180,7 @@ private:
             matrices.view = transM * rotM;
         }
 
-        viewPos = QVector4D(position, 0.0f) * QVector4D(-1.0f, 1.0f, -1.0f, 1.0f);
+        viewPos = { -position.x, position.y, -position.z };
 
         updated = true;
     };
@@ -148,9 +188,9 @@ public:
     enum CameraType { lookat, firstperson };
     CameraType type = CameraType::lookat;
 
-    QVector3D rotation;
-    QVector3D position;
-    QVector4D viewPos;
+    Vector3 rotation;
+    Vector3 position;
+    Vector3 viewPos;
 
     float rotationSpeed = 1.0f;
     float movementSpeed = 1.0f;
@@ -160,8 +200,8 @@ public:
 
     struct
     {
-        QMatrix4x4 perspective;
-        QMatrix4x4 view;
+        Matrix4 perspective;
+        Matrix4 view;
     } matrices;
 
     struct
@@ -192,9 +232,7 @@ public:
         this->zfar = zfar;
         matrices.perspective.perspective(fov, aspect, znear, zfar);
         if (flipY) {
-            auto t = matrices.perspective.row(1);
-            t[1] *= -1.0f;
-            matrices.perspective.setRow(1, t);
+            matrices.perspective(1, 1) *= -1.0f;
         }
     };
 
@@ -202,37 +240,35 @@ public:
     {
         matrices.perspective.perspective(fov, aspect, znear, zfar);
         if (flipY) {
-            auto t = matrices.perspective.row(1);
-            t[1] *= -1.0f;
-            matrices.perspective.setRow(1, t);
+            matrices.perspective(1, 1) *= -1.0f;
         }
     }
 
-    void setPosition(QVector3D position)
+    void setPosition(Vector3 position)
     {
         this->position = position;
         updateViewMatrix();
     }
 
-    void setRotation(QVector3D rotation)
+    void setRotation(Vector3 rotation)
     {
         this->rotation = rotation;
         updateViewMatrix();
     }
 
-    void rotate(QVector3D delta)
+    void rotate(Vector3 delta)
     {
         this->rotation += delta;
         updateViewMatrix();
     }
 
-    void setTranslation(QVector3D translation)
+    void setTranslation(Vector3 translation)
     {
         this->position = translation;
         updateViewMatrix();
     };
 
-    void translate(QVector3D delta)
+    void translate(Vector3 delta)
     {
         this->position += delta;
         updateViewMatrix();
@@ -255,11 +291,13 @@ public:
         {
             if (moving())
             {
-                QVector3D camFront;
-                camFront.setX(-qCos(qDegreesToRadians(rotation[0])) * qSin(qDegreesToRadians(rotation[1])));
-                camFront.setY(qSin(qDegreesToRadians(rotation[0])));
-                camFront.setZ(qCos(qDegreesToRadians(rotation[0])) * qCos(qDegreesToRadians(rotation[1])));
-                camFront.normalize();
+                float pitch = rotation[0] * std::numbers::pi_v<float> / 180.f;
+                float yaw = rotation[1] * std::numbers::pi_v<float> / 180.f;
+                Vector3 camFront;
+                camFront.x = -std::cos(pitch) * std::sin(yaw);
+                camFront.y = std::sin(pitch);
+                camFront.z = std::cos(pitch) * std::cos(yaw);
+                camFront = camFront.normalized();
 
                 float moveSpeed = deltaTime * movementSpeed;
 
@@ -268,9 +306,9 @@ public:
                 if (keys.down)
                     position -= camFront * moveSpeed;
                 if (keys.left)
-                    position -= QVector3D::crossProduct(camFront, QVector3D(0.0f, 1.0f, 0.0f)).normalized() * moveSpeed;
+                    position -= Vector3::crossProduct(camFront, Vector3{ 0.0f, 1.0f, 0.0f }).normalized() * moveSpeed;
                 if (keys.right)
-                    position += QVector3D::crossProduct(camFront, QVector3D(0.0f, 1.0f, 0.0f)).normalized() * moveSpeed;
+                    position += Vector3::crossProduct(camFront, Vector3{ 0.0f, 1.0f, 0.0f }).normalized() * moveSpeed;
 
                 updateViewMatrix();
             }
@@ -286,11 +324,12 @@ namespace Vulkan
         ::Camera camera;
         ::Frustum frustum;
 
-        QVector2D mouse_pos;
+        int32_t mouse_x = 0;
+        int32_t mouse_y = 0;
 
-        QMatrix4x4 mvp;
+        Matrix4 mvp;
         bool view_updated = true;
-        std::chrono::time_point<std::chrono::steady_clock> start_tp;
+        std::chrono::time_point<std::chrono::high_resolution_clock> start_tp;
         uint32_t frame_counter = 0;
         float frame_timer = 1.0f;
         float timer = 0.0f;
@@ -313,22 +352,26 @@ namespace Vulkan
 
         void SetPosition(float x, float y, float z) override
         {
-            camera.setPosition(QVector3D(x, y, z));
+            camera.setPosition({ x, y, z });
+            view_updated = true;
         }
 
         void SetRotation(float x, float y, float z) override
         {
-            camera.setRotation(QVector3D(x, y, z));
+            camera.setRotation({ x, y, z });
+            view_updated = true;
         }
 
         void SetPerspective(float fov, float aspect, float znear, float zfar) override
         {
             camera.setPerspective(fov, aspect, znear, zfar);
+            view_updated = true;
         }
 
         void UpdateAspectRatio(float aspect) override
         {
             camera.updateAspectRatio(aspect);
+            view_updated = true;
         }
 
         void OnKeyPressed(Key key) override
@@ -383,31 +426,41 @@ namespace Vulkan
 
         void OnMouseMove(int32_t x, int32_t y, MouseButtons buttons) override
         {
-            int32_t dx = static_cast<int32_t>(mouse_pos.x()) - x;
-            int32_t dy = static_cast<int32_t>(mouse_pos.y()) - y;
+            int32_t dx = mouse_x - x;
+            int32_t dy = mouse_y - y;
 
             if (buttons & MouseButtons::Left)
             {
-                camera.rotate(QVector3D(dy * camera.rotationSpeed, -dx * camera.rotationSpeed, 0.0f));
+                camera.rotate({ dy * camera.rotationSpeed, -dx * camera.rotationSpeed, 0.0f });
                 view_updated = true;
             }
             if (buttons & MouseButtons::Right)
             {
-                camera.translate(QVector3D(-0.0f, 0.0f, dy * .005f));
+                camera.translate({ -0.0f, 0.0f, dy * .005f });
                 view_updated = true;
             }
             if (buttons & MouseButtons::Middle)
             {
-                camera.translate(QVector3D(-dx * 0.01f, -dy * 0.01f, 0.0f));
+                camera.translate({ -dx * 0.01f, -dy * 0.01f, 0.0f });
                 view_updated = true;
             }
-            mouse_pos.setX(x);
-            mouse_pos.setY(y);
+            mouse_x = x;
+            mouse_y = y;
         }
 
         bool ObjectVisible(const BBox& bbox) const override
         {
-            return frustum.checkBox(AAbox(bbox));
+            return Vulkan::BoxVisible(frustum.culling_planes, bbox);
+        }
+
+        Visibility ClassifyBox(const BBox& bbox) const override
+        {
+            return Vulkan::ClassifyBox(frustum.culling_planes, bbox);
+        }
+
+        void CullBoxes(std::span<const BBox> boxes, std::span<uint64_t> visible) const override
+        {
+            Vulkan::CullBoxes(frustum.culling_planes, boxes, visible);
         }
 
         void BeforeRender() override
@@ -421,29 +474,17 @@ namespace Vulkan
             }
         }
 
-        virtual void Push(QVulkanDeviceFunctions& funcs, VkCommandBuffer cmd_buf, VkPipelineLayout layout) const
-        {
-            funcs.vkCmdPushConstants(
-                cmd_buf,
-                layout,
-                VK_SHADER_STAGE_VERTEX_BIT,
-                mvp_layout.GetOffset(),
-                mvp_layout.GetSize(),
-                mvp.constData()
-            );
-        }
-
         std::string GetInfoString() const
         {
             std::string res;
             res += " - " + std::to_string(frame_counter) + " fps";
-            res += " - " + std::to_string(camera.viewPos.x()) + "; "
-                + std::to_string(camera.viewPos.y()) + "; "
-                + std::to_string(camera.viewPos.z()) + "; ";
+            res += " - " + std::to_string(camera.viewPos.x) + "; "
+                + std::to_string(camera.viewPos.y) + "; "
+                + std::to_string(camera.viewPos.z) + "; ";
 
-            res += " - " + std::to_string(camera.rotation.x()) + "; "
-                + std::to_string(camera.rotation.y()) + "; "
-                + std::to_string(camera.rotation.z()) + "; ";
+            res += " - " + std::to_string(camera.rotation.x) + "; "
+                + std::to_string(camera.rotation.y) + "; "
+                + std::to_string(camera.rotation.z) + "; ";
 
             return res;
         }
@@ -492,7 +533,22 @@ namespace Vulkan
 
         Vector3f GetViewPos() const override
         {
-            return { camera.viewPos.x(), camera.viewPos.y(), camera.viewPos.z(), };
+            return { camera.viewPos.x, camera.viewPos.y, camera.viewPos.z, };
+        }
+
+        Vector3f GetPosition() const override
+        {
+            return { camera.position.x, camera.position.y, camera.position.z };
+        }
+
+        Vector3f GetRotation() const override
+        {
+            return { camera.rotation.x, camera.rotation.y, camera.rotation.z };
+        }
+
+        std::array<float, 16> GetViewProjection() const override
+        {
+            return mvp.data;
         }
 
         virtual ~Camera() = default;
@@ -1,4 +1,4 @@
-#include <QVulkanFunctions>
+#pragma once
 
 #include "ICamera.h"
 #include "IRenderer.h"
@@ -20,11 +20,11 @@ namespace Vulkan
         uint32_t offset = 0u;
     };
 
+    // The render pass pushes GetViewProjection with the layout of GetMvpLayout
     struct CameraRaii
         : public ICamera
     {
         virtual void BeforeRender() = 0;
-        virtual void Push(QVulkanDeviceFunctions& funcs, VkCommandBuffer cmd_buf, VkPipelineLayout layout) const = 0;
         virtual void AfterRender() = 0;
         virtual ~CameraRaii() = default;
     };
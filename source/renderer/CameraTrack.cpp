@@ -0,0 +1,188 @@
+#include "CameraTrack.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace Vulkan
+{
+
+constexpr const char* g_track_header = "camera_track 1";
+
+static float Lerp(float a, float b, float t)
+{
+    return a + (b - a) * t;
+}
+
+static Vector3f Lerp(const Vector3f& a, const Vector3f& b, float t)
+{
+    return { Lerp(a.x, b.x, t), Lerp(a.y, b.y, t), Lerp(a.z, b.z, t) };
+}
+
+void CameraTrack::Add(const CameraKey& key)
+{
+    if (!keys.empty() && key.time < keys.back().time)
+        throw std::invalid_argument("Camera keys must be added in time order");
+    keys.push_back(key);
+}
+
+bool CameraTrack::Empty() const
+{
+    return keys.empty();
+}
+
+double CameraTrack::GetDuration() const
+{
+    return keys.empty() ? 0.0 : keys.back().time - keys.front().time;
+}
+
+const std::vector<CameraKey>& CameraTrack::GetKeys() const
+{
+    return keys;
+}
+
+CameraKey CameraTrack::Sample(double time) const
+{
+    if (keys.empty())
+        return {};
+
+    auto at = keys.front().time + time;
+    auto next = std::upper_bound(keys.begin(), keys.end(), at, [](double t, const CameraKey& key) {
+        return t < key.time;
+    });
+    if (next == keys.begin())
+        return keys.front();
+    if (next == keys.end())
+        return keys.back();
+
+    const auto& a = *(next - 1);
+    const auto& b = *next;
+    auto t = static_cast<float>((at - a.time) / (b.time - a.time));
+    return { at, Lerp(a.position, b.position, t), Lerp(a.rotation, b.rotation, t) };
+}
+
+void CameraTrack::Apply(ICamera& camera, double time) const
+{
+    auto key = Sample(time);
+    camera.SetPosition(key.position.x, key.position.y, key.position.z);
+    camera.SetRotation(key.rotation.x, key.rotation.y, key.rotation.z);
+}
+
+void CameraTrack::Write(std::ostream& out) const
+{
+    out << g_track_header << '\n';
+    // Enough digits for the double times, the float poses read back exactly as well
+    out << std::setprecision(std::numeric_limits<double>::max_digits10);
+    for (const auto& key : keys)
+    {
+        out << key.time << ' '
+            << key.position.x << ' ' << key.position.y << ' ' << key.position.z << ' '
+            << key.rotation.x << ' ' << key.rotation.y << ' ' << key.rotation.z << '\n';
+    }
+}
+
+bool CameraTrack::Read(std::istream& in)
+{
+    keys.clear();
+
+    std::string header;
+    if (!std::getline(in, header) || header != g_track_header)
+        return false;
+
+    std::string line;
+    while (std::getline(in, line))
+    {
+        if (line.empty())
+            continue;
+
+        CameraKey key;
+        std::istringstream fields(line);
+        fields >> key.time
+            >> key.position.x >> key.position.y >> key.position.z
+            >> key.rotation.x >> key.rotation.y >> key.rotation.z;
+        if (!fields || (!keys.empty() && key.time < keys.back().time))
+        {
+            keys.clear();
+            return false;
+        }
+        keys.push_back(key);
+    }
+    return true;
+}
+
+bool CameraTrack::Save(const std::string& path) const
+{
+    std::ofstream out(path);
+    if (!out)
+        return false;
+
+    Write(out);
+    return !!out;
+}
+
+bool CameraTrack::Load(const std::string& path)
+{
+    std::ifstream in(path);
+    return in && Read(in);
+}
+
+void CameraRecorder::Start()
+{
+    track = {};
+    start = Clock::now();
+    recording = true;
+}
+
+CameraTrack CameraRecorder::Stop()
+{
+    recording = false;
+    return std::move(track);
+}
+
+bool CameraRecorder::IsRecording() const
+{
+    return recording;
+}
+
+void CameraRecorder::OnFrame(const ICamera& camera)
+{
+    if (!recording)
+        return;
+
+    auto time = std::chrono::duration<double>(Clock::now() - start).count();
+    track.Add({ time, camera.GetPosition(), camera.GetRotation() });
+}
+
+CameraPlayer::CameraPlayer(CameraTrack track, double time_step)
+    : track(std::move(track))
+    , time_step(time_step)
+{
+    if (time_step <= 0.0)
+        throw std::invalid_argument("Playback time step must be positive");
+}
+
+bool CameraPlayer::Step(ICamera& camera)
+{
+    if (IsFinished())
+        return false;
+
+    track.Apply(camera, frame * time_step);
+    ++frame;
+    return true;
+}
+
+bool CameraPlayer::IsFinished() const
+{
+    // The last frame played lands on the last key or just past it
+    return track.Empty() || (frame > 0u && (frame - 1u) * time_step >= track.GetDuration());
+}
+
+uint64_t CameraPlayer::GetFrame() const
+{
+    return frame;
+}
+
+}
@@ -5,13 +5,21 @@
 namespace Vulkan
 {
 
+class RetireQueue;
+class UploadBatch;
+class StorageDescriptors;
+
 struct VulkanShared
 {
-    VkDevice         device          = nullptr;
-    VkPhysicalDevice physical_device = nullptr;
-    VkCommandPool    command_pool    = nullptr;
-    VkQueue          graphics_queue  = nullptr;
-    VkRenderPass     render_pass     = nullptr;
+    VkDevice              device              = nullptr;
+    VkPhysicalDevice      physical_device     = nullptr;
+    VkQueue               graphics_queue      = nullptr;
+    VkRenderPass          render_pass         = nullptr;
+    VkPipelineCache       pipeline_cache      = nullptr;
+    RetireQueue*          retire_queue        = nullptr;
+    UploadBatch*          upload_batch        = nullptr;
+    // Set 1 of every pipeline layout, the storage buffer a draw pulls its instances from
+    StorageDescriptors*   storage_descriptors = nullptr;
 
     uint32_t host_memory_index   = 0u;
     uint32_t device_memory_index = 0u;
@@ -7,9 +7,110 @@
 #include <QVulkanFunctions>
 #include <QVulkanWindow>
 
+#include <array>
+
 namespace Vulkan
 {
-    DescriptorSet::DescriptorSet(const InputResources& bindings, const QVulkanWindow& window)
+    // Sets per pool, a pool is added for every this many chunks in view
+    constexpr uint32_t g_storage_pool_size = 256u;
+
+    StorageDescriptors::StorageDescriptors(VkDevice device)
+        : device(device)
+    {
+        VkDescriptorSetLayoutBinding binding{};
+        binding.binding = 0;
+        binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        binding.descriptorCount = 1;
+        binding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+        VkDescriptorSetLayoutCreateInfo layout_info{};
+        layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layout_info.pBindings = &binding;
+        layout_info.bindingCount = 1;
+
+        Vulkan::VkResultSuccess(vkCreateDescriptorSetLayout(device, &layout_info, nullptr, &layout));
+    }
+
+    StorageDescriptors::~StorageDescriptors()
+    {
+        for (auto pool : pools)
+            vkDestroyDescriptorPool(device, pool, nullptr);
+        // Pipeline layouts created with it stay valid
+        vkDestroyDescriptorSetLayout(device, layout, nullptr);
+    }
+
+    StorageDescriptor StorageDescriptors::Allocate(VkBuffer buffer)
+    {
+        StorageDescriptor res;
+
+        VkDescriptorSetAllocateInfo set_info{};
+        set_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        set_info.pSetLayouts        = &layout;
+        set_info.descriptorSetCount = 1;
+        {
+            std::lock_guard lock(mutex);
+            // Newest first, the older pools only have room where sets were freed
+            for (auto it = pools.rbegin(); it != pools.rend() && !res.set; ++it)
+            {
+                set_info.descriptorPool = *it;
+                auto result = vkAllocateDescriptorSets(device, &set_info, &res.set);
+                if (result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL)
+                    continue;
+                Vulkan::VkResultSuccess(result);
+                res.pool = *it;
+            }
+
+            if (!res.set)
+            {
+                pools.push_back(CreatePool());
+                set_info.descriptorPool = pools.back();
+                Vulkan::VkResultSuccess(vkAllocateDescriptorSets(device, &set_info, &res.set));
+                res.pool = pools.back();
+            }
+        }
+
+        VkDescriptorBufferInfo buffer_info{};
+        buffer_info.buffer = buffer;
+        buffer_info.offset = 0;
+        buffer_info.range  = VK_WHOLE_SIZE;
+
+        VkWriteDescriptorSet write_descriptor_set{};
+        write_descriptor_set.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write_descriptor_set.dstSet = res.set;
+        write_descriptor_set.dstBinding = 0;
+        write_descriptor_set.descriptorCount = 1;
+        write_descriptor_set.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        write_descriptor_set.pBufferInfo = &buffer_info;
+        // The new set is not shared yet, writing it needs no lock
+        vkUpdateDescriptorSets(device, 1, &write_descriptor_set, 0, nullptr);
+        return res;
+    }
+
+    void StorageDescriptors::Free(const StorageDescriptor& descriptor)
+    {
+        std::lock_guard lock(mutex);
+        Vulkan::VkResultSuccess(vkFreeDescriptorSets(device, descriptor.pool, 1, &descriptor.set));
+    }
+
+    VkDescriptorPool StorageDescriptors::CreatePool() const
+    {
+        VkDescriptorPoolSize pool_size{};
+        pool_size.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        pool_size.descriptorCount = g_storage_pool_size;
+
+        VkDescriptorPoolCreateInfo pool_info{};
+        pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        pool_info.flags         = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+        pool_info.poolSizeCount = 1;
+        pool_info.pPoolSizes    = &pool_size;
+        pool_info.maxSets       = g_storage_pool_size;
+
+        VkDescriptorPool res = nullptr;
+        Vulkan::VkResultSuccess(vkCreateDescriptorPool(device, &pool_info, nullptr, &res));
+        return res;
+    }
+
+    DescriptorSet::DescriptorSet(const InputResources& bindings, VkDescriptorSetLayout storage_set_layout, const QVulkanWindow& window)
         : device(window.device())
         , functions(*window.vulkanInstance()->deviceFunctions(window.device()))
     {
@@ -85,10 +186,14 @@ namespace Vulkan
 
         Vulkan::VkResultSuccess(device_functions.vkCreateDescriptorSetLayout(device, &descriptor_set_layout_info, nullptr, &descriptor_set_layout));
 
+        // The storage set is bound per draw, pipelines that draw no storage buffers never touch it
+        std::array<VkDescriptorSetLayout, 2> set_layouts = { descriptor_set_layout, storage_set_layout };
+        static_assert(storage_set_index == 1u, "The storage set follows the input resources");
+
         VkPipelineLayoutCreateInfo pipeline_layout_info{};
         pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-        pipeline_layout_info.setLayoutCount = 1;
-        pipeline_layout_info.pSetLayouts = &descriptor_set_layout;
+        pipeline_layout_info.setLayoutCount = static_cast<uint32_t>(set_layouts.size());
+        pipeline_layout_info.pSetLayouts = set_layouts.data();
         pipeline_layout_info.pushConstantRangeCount = static_cast<uint32_t>(push_constant_ranges.size());
         pipeline_layout_info.pPushConstantRanges = push_constant_ranges.data();
 
@@ -4,16 +4,54 @@
 #include "IRenderer.h"
 #include "IFactory.h"
 
+#include <mutex>
+#include <vector>
+
 class QVulkanDeviceFunctions;
 class QVulkanWindow;
 
 namespace Vulkan
 {
+    // Set of the storage buffer a draw pulls its instances from, after the set of the input resources
+    constexpr uint32_t storage_set_index = 1u;
+
+    struct StorageDescriptor
+    {
+        VkDescriptorPool pool = nullptr;
+        VkDescriptorSet  set  = nullptr;
+    };
+
+    // Sets of the storage buffers, one storage buffer read by the vertex stage each. They come from
+    // a list of pools shared by all buffers, a new pool is added once the existing ones run out.
+    // Any thread, the pools are only touched under the mutex
+    class StorageDescriptors
+    {
+    public:
+        explicit StorageDescriptors(VkDevice device);
+        // Frees the pools with every set left in them
+        ~StorageDescriptors();
+
+        VkDescriptorSetLayout GetLayout() const { return layout; }
+
+        // A set pointing to the whole buffer
+        StorageDescriptor Allocate(VkBuffer buffer);
+        void Free(const StorageDescriptor& descriptor);
+
+    private:
+        VkDescriptorPool CreatePool() const;
+
+        VkDevice              device = nullptr;
+        VkDescriptorSetLayout layout = nullptr;
+
+        std::mutex                    mutex;
+        std::vector<VkDescriptorPool> pools;
+    };
+
     class DescriptorSet
         : public IDescriptorSet
     {
     public:
-        DescriptorSet(const InputResources&, const QVulkanWindow&);
+        DescriptorSet(const InputResources&, VkDescriptorSetLayout storage_set_layout, const QVulkanWindow&);
         ~DescriptorSet() override;
 
         void Bind(QVulkanDeviceFunctions& vulkan, VkCommandBuffer cmd_buf) const;
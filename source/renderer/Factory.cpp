@@ -10,6 +10,9 @@
 #include "DescriptorSet.h"
 #include "Pipeline.h"
 #include "RenderPass.h"
+#include "PipelineCache.h"
+#include "RetireQueue.h"
+#include "UploadBatch.h"
 
 #include <deque>
 #include <set>
@@ -19,6 +22,7 @@ namespace Vulkan
 {
 
 constexpr uint32_t g_invalid_index = std::numeric_limits<uint32_t>::max();
+constexpr const char* g_pipeline_cache_path = "pipeline_cache.bin";
 
 class Factory
     : public IFactory
@@ -29,13 +33,19 @@ public:
         , vulkan({
             .device              = window.device(),
             .physical_device     = window.physicalDevice(),
-            .command_pool        = window.graphicsCommandPool(),
             .graphics_queue      = window.graphicsQueue(),
             .render_pass         = window.defaultRenderPass(),
             .host_memory_index   = window.hostVisibleMemoryIndex(),
             .device_memory_index = window.deviceLocalMemoryIndex(),
         })
+        , storage_descriptors(std::make_unique<StorageDescriptors>(window.device()))
+        , retire_queue(std::make_unique<RetireQueue>(vulkan))
+        , pipeline_cache(std::make_unique<PipelineCache>(g_pipeline_cache_path, vulkan))
     {
+        vulkan.retire_queue = retire_queue.get();
+        vulkan.pipeline_cache = pipeline_cache->Get();
+        vulkan.storage_descriptors = storage_descriptors.get();
+
         uint32_t queueCount;
         vkGetPhysicalDeviceQueueFamilyProperties(vulkan.physical_device, &queueCount, NULL);
         assert(queueCount >= 1);
@@ -61,6 +71,9 @@ public:
         }
 
         queue_node_index = graphicsQueueNodeIndex;
+
+        upload_batch = std::make_unique<UploadBatch>(vulkan, queue_node_index);
+        vulkan.upload_batch = upload_batch.get();
     }
 
     ~Factory() override = default;
@@ -72,7 +85,7 @@ public:
 
     std::unique_ptr<IRenderPass> CreateRenderPass(ICamera& camera) const override
     {
-        return std::make_unique<RenderPass>(camera, window);
+        return std::make_unique<RenderPass>(camera, window, *upload_batch, *retire_queue);
     }
 
     ITexture& CreateTexture(const IDataProvider& data) override
@@ -98,6 +111,16 @@ public:
         return std::make_unique<Buffer>(usage, data, vulkan);
     }
 
+    std::unique_ptr<IStagingBuffer> CreateStagingBuffer(uint32_t size) override
+    {
+        return std::make_unique<StagingBuffer>(size, vulkan);
+    }
+
+    std::unique_ptr<IBuffer> CommitBuffer(BufferUsage usage, std::unique_ptr<IStagingBuffer> staging, uint32_t width) override
+    {
+        return std::make_unique<Buffer>(usage, dynamic_cast<const StagingBuffer&>(*staging), width, vulkan);
+    }
+
     IShader& CreateShader(const IDataProvider& data, ShaderType type) override
     {
         shaders.emplace_back(data, type, window);
@@ -106,7 +129,7 @@ public:
 
     IDescriptorSet& CreateDescriptorSet(const InputResources& bindings) override
     {
-        desc_sets.emplace_back(bindings, window);
+        desc_sets.emplace_back(bindings, storage_descriptors->GetLayout(), window);
         return desc_sets.back();
     }
 
@@ -125,6 +148,15 @@ public:
     }
 
 private:
+    // Resources below retire into the queue and record their uploads into the batch, both must outlive them
+    VulkanShared                        vulkan;
+    // Retired storage buffers free their sets into it
+    std::unique_ptr<StorageDescriptors> storage_descriptors;
+    std::unique_ptr<RetireQueue>        retire_queue;
+    std::unique_ptr<UploadBatch>        upload_batch;
+    // Written back to its file when the factory is destroyed
+    std::unique_ptr<PipelineCache>      pipeline_cache;
+
     std::deque<Texture>        textures;
     std::deque<Buffer>         buffers;
     std::deque<VertexLayout>   vertex_layouts;
@@ -133,8 +165,6 @@ private:
     std::deque<Pipeline>       pipelines;
     std::deque<CommandBuffer>  command_buffers;
 
-    VulkanShared vulkan;
-
     uint32_t queue_node_index = g_invalid_index;
 
     const QVulkanWindow& window;
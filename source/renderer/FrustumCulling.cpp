@@ -0,0 +1,105 @@
+#include "FrustumCulling.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define FRUSTUM_CULLING_SSE
+#endif
+
+namespace Vulkan
+{
+    static float Distance(const Plane& plane, float x, float y, float z)
+    {
+        return plane.x * x + plane.y * y + plane.z * z + plane.w;
+    }
+
+    bool BoxVisible(const FrustumPlanes& planes, const BBox& box)
+    {
+        for (const auto& plane : planes)
+        {
+            float x = plane.x >= 0 ? box.max_x : box.min_x;
+            float y = plane.y >= 0 ? box.max_y : box.min_y;
+            float z = plane.z >= 0 ? box.max_z : box.min_z;
+            if (Distance(plane, x, y, z) <= 0)
+                return false;
+        }
+        return true;
+    }
+
+    Visibility ClassifyBox(const FrustumPlanes& planes, const BBox& box)
+    {
+        auto res = Visibility::Inside;
+        for (const auto& plane : planes)
+        {
+            float x = plane.x >= 0 ? box.max_x : box.min_x;
+            float y = plane.y >= 0 ? box.max_y : box.min_y;
+            float z = plane.z >= 0 ? box.max_z : box.min_z;
+            if (Distance(plane, x, y, z) <= 0)
+                return Visibility::Outside;
+
+            x = plane.x >= 0 ? box.min_x : box.max_x;
+            y = plane.y >= 0 ? box.min_y : box.max_y;
+            z = plane.z >= 0 ? box.min_z : box.max_z;
+            if (Distance(plane, x, y, z) <= 0)
+                res = Visibility::Intersects;
+        }
+        return res;
+    }
+
+    void CullBoxes(const FrustumPlanes& planes, std::span<const BBox> boxes, std::span<uint64_t> visible)
+    {
+        const size_t words = (boxes.size() + 63) / 64;
+        if (visible.size() < words)
+            throw std::invalid_argument("Visibility mask is smaller than the box count");
+
+        std::fill_n(visible.begin(), words, 0ull);
+
+        size_t i = 0;
+#ifdef FRUSTUM_CULLING_SSE
+        __m128 coefficients[6][4];
+        for (size_t p = 0; p < planes.size(); ++p)
+        {
+            coefficients[p][0] = _mm_set1_ps(planes[p].x);
+            coefficients[p][1] = _mm_set1_ps(planes[p].y);
+            coefficients[p][2] = _mm_set1_ps(planes[p].z);
+            coefficients[p][3] = _mm_set1_ps(planes[p].w);
+        }
+
+        for (; i + 4 <= boxes.size(); i += 4)
+        {
+            const BBox* b = boxes.data() + i;
+            const __m128 min_x = _mm_setr_ps(b[0].min_x, b[1].min_x, b[2].min_x, b[3].min_x);
+            const __m128 min_y = _mm_setr_ps(b[0].min_y, b[1].min_y, b[2].min_y, b[3].min_y);
+            const __m128 min_z = _mm_setr_ps(b[0].min_z, b[1].min_z, b[2].min_z, b[3].min_z);
+            const __m128 max_x = _mm_setr_ps(b[0].max_x, b[1].max_x, b[2].max_x, b[3].max_x);
+            const __m128 max_y = _mm_setr_ps(b[0].max_y, b[1].max_y, b[2].max_y, b[3].max_y);
+            const __m128 max_z = _mm_setr_ps(b[0].max_z, b[1].max_z, b[2].max_z, b[3].max_z);
+
+            int inside = 0xF;
+            for (size_t p = 0; p < planes.size() && inside; ++p)
+            {
+                const auto& c = coefficients[p];
+                const __m128 x = planes[p].x >= 0 ? max_x : min_x;
+                const __m128 y = planes[p].y >= 0 ? max_y : min_y;
+                const __m128 z = planes[p].z >= 0 ? max_z : min_z;
+
+                // Same evaluation order as Distance, so both paths agree on boxes touching a plane
+                __m128 distance = _mm_add_ps(_mm_mul_ps(c[0], x), _mm_mul_ps(c[1], y));
+                distance = _mm_add_ps(distance, _mm_mul_ps(c[2], z));
+                distance = _mm_add_ps(distance, c[3]);
+                inside &= _mm_movemask_ps(_mm_cmpgt_ps(distance, _mm_setzero_ps()));
+            }
+
+            visible[i / 64] |= static_cast<uint64_t>(inside) << (i % 64);
+        }
+#endif
+
+        for (; i < boxes.size(); ++i)
+        {
+            if (BoxVisible(planes, boxes[i]))
+                visible[i / 64] |= 1ull << (i % 64);
+        }
+    }
+}
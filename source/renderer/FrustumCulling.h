@@ -0,0 +1,27 @@
+#pragma once
+
+#include "ICamera.h"
+
+#include <array>
+
+namespace Vulkan
+{
+    struct Plane
+    {
+        float x = 0.f;
+        float y = 0.f;
+        float z = 0.f;
+        float w = 0.f;
+    };
+
+    using FrustumPlanes = std::array<Plane, 6>;
+
+    // A box is visible when its positive vertex is in front of every plane
+    bool BoxVisible(const FrustumPlanes& planes, const BBox& box);
+
+    // Inside when the negative vertex is in front of every plane as well
+    Visibility ClassifyBox(const FrustumPlanes& planes, const BBox& box);
+
+    // Sets bit i % 64 of visible[i / 64] for every visible box, four boxes per SSE register
+    void CullBoxes(const FrustumPlanes& planes, std::span<const BBox> boxes, std::span<uint64_t> visible);
+}
@@ -11,6 +11,7 @@ namespace Vulkan
 
 Pipeline::Pipeline(const DescriptorSet& descriptor_set, const Shaders& shaders, const VertexLayout& vertex_layout, VulkanShared& vulkan)
     : vulkan(vulkan)
+    , vertex_count(vertex_layout.GetVertexCount())
 {
     VkPipelineInputAssemblyStateCreateInfo input_assembly_state_info{};
     input_assembly_state_info.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
@@ -105,17 +106,12 @@ Pipeline::Pipeline(const DescriptorSet& descriptor_set, const Shaders& shaders,
     pipeline_info.stageCount           = static_cast<uint32_t>(shader_info.size());
     pipeline_info.pStages              = shader_info.data();
 
-    VkPipelineCacheCreateInfo pipelineCacheCreateInfo = {};
-    pipelineCacheCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
-
-    Vulkan::VkResultSuccess(vkCreatePipelineCache(vulkan.device, &pipelineCacheCreateInfo, nullptr, &pipeline_cache));
-    Vulkan::VkResultSuccess(vkCreateGraphicsPipelines(vulkan.device, pipeline_cache, 1, &pipeline_info, nullptr, &pipeline));
+    Vulkan::VkResultSuccess(vkCreateGraphicsPipelines(vulkan.device, vulkan.pipeline_cache, 1, &pipeline_info, nullptr, &pipeline));
 }
 
 Pipeline::~Pipeline()
 {
     vkDestroyPipeline(vulkan.device, pipeline, nullptr);
-    vkDestroyPipelineCache(vulkan.device, pipeline_cache, nullptr);
 }
 
 void Pipeline::Bind(VkCommandBuffer cmd_buf) const
@@ -19,11 +19,14 @@ public:
 
     void Bind(VkCommandBuffer cmd_buf) const;
 
+    // Vertices of each instance drawn from a storage buffer
+    uint32_t GetVertexCount() const { return vertex_count; }
+
 private:
     VulkanShared& vulkan;
 
-    VkPipeline      pipeline = nullptr;
-    VkPipelineCache pipeline_cache = nullptr;
+    VkPipeline pipeline = nullptr;
+    uint32_t   vertex_count = 0u;
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,129 @@
+#include <Profiler.h>
+
+#include "PipelineCache.h"
+
+#include "Common.h"
+#include "Utils.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace Vulkan
+{
+
+constexpr uint32_t g_cache_magic = 0x43505651u; // "QVPC"
+constexpr uint32_t g_cache_version = 1u;
+
+struct CacheFileHeader
+{
+    uint32_t magic = g_cache_magic;
+    uint32_t version = g_cache_version;
+    uint32_t vendor_id = 0u;
+    uint32_t device_id = 0u;
+    uint32_t driver_version = 0u;
+    uint8_t  uuid[VK_UUID_SIZE] = {};
+    uint64_t data_size = 0u;
+};
+
+static CacheFileHeader GetHeader(const VkPhysicalDeviceProperties& properties)
+{
+    CacheFileHeader header;
+    header.vendor_id = properties.vendorID;
+    header.device_id = properties.deviceID;
+    header.driver_version = properties.driverVersion;
+    std::copy(std::begin(properties.pipelineCacheUUID), std::end(properties.pipelineCacheUUID), header.uuid);
+    return header;
+}
+
+static bool Matches(const CacheFileHeader& lhs, const CacheFileHeader& rhs)
+{
+    return lhs.magic == rhs.magic
+        && lhs.version == rhs.version
+        && lhs.vendor_id == rhs.vendor_id
+        && lhs.device_id == rhs.device_id
+        && lhs.driver_version == rhs.driver_version
+        && std::equal(std::begin(lhs.uuid), std::end(lhs.uuid), std::begin(rhs.uuid));
+}
+
+// Empty when the file is missing, truncated or was written for another device
+static std::vector<uint8_t> ReadCacheFile(const std::string& path, const CacheFileHeader& expected)
+{
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    auto file_size = static_cast<uint64_t>(std::max<std::streamoff>(in.tellg(), 0));
+    in.seekg(0);
+
+    CacheFileHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) || !Matches(header, expected))
+        return {};
+
+    // Checked before allocating, a corrupted size must not reach the allocator
+    if (header.data_size != file_size - sizeof(header))
+        return {};
+
+    std::vector<uint8_t> data(header.data_size);
+    if (!in.read(reinterpret_cast<char*>(data.data()), data.size()))
+        return {};
+    return data;
+}
+
+PipelineCache::PipelineCache(std::string cache_path, VulkanShared& vulkan)
+    : vulkan(vulkan)
+    , path(std::move(cache_path))
+{
+    PROFILE_ZONE("PipelineCache load");
+    vkGetPhysicalDeviceProperties(vulkan.physical_device, &properties);
+    auto data = ReadCacheFile(path, GetHeader(properties));
+
+    VkPipelineCacheCreateInfo create_info = {};
+    create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    create_info.initialDataSize = data.size();
+    create_info.pInitialData = data.data();
+
+    // The driver validates the data again, a cache it refuses is dropped rather than failing the start
+    if (vkCreatePipelineCache(vulkan.device, &create_info, nullptr, &cache) == VK_SUCCESS)
+        return;
+
+    create_info.initialDataSize = 0;
+    create_info.pInitialData = nullptr;
+    VkResultSuccess(vkCreatePipelineCache(vulkan.device, &create_info, nullptr, &cache));
+}
+
+PipelineCache::~PipelineCache()
+{
+    Save();
+    vkDestroyPipelineCache(vulkan.device, cache, nullptr);
+}
+
+bool PipelineCache::Save() const
+{
+    PROFILE_ZONE("PipelineCache save");
+    size_t size = 0;
+    if (vkGetPipelineCacheData(vulkan.device, cache, &size, nullptr) != VK_SUCCESS)
+        return false;
+
+    std::vector<uint8_t> data(size);
+    if (vkGetPipelineCacheData(vulkan.device, cache, &size, data.data()) != VK_SUCCESS)
+        return false;
+
+    auto header = GetHeader(properties);
+    header.data_size = size;
+
+    // Written aside and renamed, so a crash while saving never leaves a truncated cache behind
+    auto temp_path = path + ".tmp";
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(data.data()), size);
+        if (!out)
+            return false;
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temp_path, path, error);
+    return !error;
+}
+
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <string>
+
+namespace Vulkan
+{
+
+struct VulkanShared;
+
+// Pipeline cache kept in a file between launches. The file is only used when it was written
+// by the same version of this code for the same device and driver, otherwise the cache starts empty.
+class PipelineCache
+{
+public:
+    PipelineCache(std::string path, VulkanShared& vulkan);
+    // Saves the cache back to its file
+    ~PipelineCache();
+
+    VkPipelineCache Get() const { return cache; }
+
+    bool Save() const;
+
+private:
+    VulkanShared& vulkan;
+    std::string   path;
+
+    VkPhysicalDeviceProperties properties{};
+    VkPipelineCache            cache = nullptr;
+};
+
+}
@@ -0,0 +1,290 @@
+#include "IFactory.h"
+#include "IRenderer.h"
+
+#include "BufferRanges.h"
+#include "Camera.h"
+
+#include <deque>
+#include <vector>
+
+namespace Vulkan
+{
+
+namespace
+{
+
+class RecordingBuffer
+    : public IBuffer
+{
+public:
+    RecordingBuffer(const IDataProvider& data, RecordingStats& stats)
+        : RecordingBuffer(data.GetSize(), data.GetWidth(), stats)
+    {
+    }
+
+    RecordingBuffer(uint32_t size, uint32_t count, RecordingStats& stats)
+        : stats(stats)
+        , size(size)
+        , count(count)
+    {
+        ++stats.buffers_created;
+        ++stats.buffers_alive;
+        stats.buffer_bytes_alive += size;
+        stats.bytes_uploaded += size;
+    }
+
+    ~RecordingBuffer() override
+    {
+        --stats.buffers_alive;
+        stats.buffer_bytes_alive -= size;
+    }
+
+    void Update(const IDataProvider& data) override
+    {
+        ++stats.buffer_updates;
+        stats.bytes_uploaded += data.GetSize();
+    }
+
+    void Update(uint32_t offset, std::span<const uint8_t> data) override
+    {
+        const BufferRange range = { offset, data };
+        Update(std::span(&range, 1));
+    }
+
+    void Update(std::span<const BufferRange> ranges) override
+    {
+        ++stats.buffer_updates;
+        stats.bytes_uploaded += CheckBufferRanges(ranges, size);
+    }
+
+    uint32_t GetCount() const
+    {
+        return count;
+    }
+
+private:
+    RecordingStats& stats;
+    uint32_t        size = 0u;
+    uint32_t        count = 0u;
+};
+
+class RecordingStagingBuffer
+    : public IStagingBuffer
+{
+public:
+    RecordingStagingBuffer(uint32_t size, RecordingStats& stats)
+        : data(size)
+    {
+        ++stats.staging_buffers_created;
+    }
+
+    std::span<uint8_t> GetData() override
+    {
+        return data;
+    }
+
+private:
+    std::vector<uint8_t> data;
+};
+
+struct RecordingTexture
+    : public ITexture
+{
+};
+
+struct RecordingShader
+    : public IShader
+{
+};
+
+struct RecordingDescriptorSet
+    : public IDescriptorSet
+{
+};
+
+struct RecordingPipeline
+    : public IPipeline
+{
+};
+
+struct RecordingVertexBinding
+    : public IVertexBinding
+{
+    void AddAttribute(AttributeFormat) override
+    {
+    }
+};
+
+class RecordingVertexLayout
+    : public IVertexLayout
+{
+public:
+    IVertexBinding& AddVertexBinding() override
+    {
+        return bindings.emplace_back();
+    }
+
+    IVertexBinding& AddInstanceBinding() override
+    {
+        return bindings.emplace_back();
+    }
+
+    void SetVertexCount(uint32_t) override
+    {
+    }
+
+private:
+    std::deque<RecordingVertexBinding> bindings;
+};
+
+class RecordingCommandBuffer
+    : public ICommandBuffer
+{
+public:
+    explicit RecordingCommandBuffer(RecordingStats& stats)
+        : stats(stats)
+    {
+    }
+
+    void Bind(const IDescriptorSet&) const override
+    {
+    }
+
+    void Bind(const IPipeline&) const override
+    {
+    }
+
+    void Bind(const IBuffer&) const override
+    {
+    }
+
+    void Draw(const IBuffer& buffer, uint32_t count, uint32_t) const override
+    {
+        ++stats.draw_calls;
+        stats.instances_drawn += count ? count : dynamic_cast<const RecordingBuffer&>(buffer).GetCount();
+    }
+
+private:
+    RecordingStats& stats;
+};
+
+class RecordingRenderPass
+    : public IRenderPass
+{
+public:
+    RecordingRenderPass(ICamera& camera, RecordingStats& stats)
+        : camera_raii(dynamic_cast<CameraRaii*>(&camera))
+    {
+        ++stats.render_passes;
+        if (camera_raii)
+            camera_raii->BeforeRender();
+    }
+
+    ~RecordingRenderPass() override
+    {
+        if (camera_raii)
+            camera_raii->AfterRender();
+    }
+
+    void AddCommandBuffer(ICommandBuffer&) override
+    {
+    }
+
+private:
+    CameraRaii* camera_raii = nullptr;
+};
+
+class RecordingFactory
+    : public IFactory
+{
+public:
+    RecordingFactory(RecordingStats& stats, uint32_t frame_buffer_count)
+        : stats(stats)
+        , frame_buffer_count(frame_buffer_count)
+    {
+    }
+
+    ~RecordingFactory() override = default;
+
+    uint32_t GetFrameBufferCount() const override
+    {
+        return frame_buffer_count;
+    }
+
+    std::unique_ptr<IRenderPass> CreateRenderPass(ICamera& camera) const override
+    {
+        return std::make_unique<RecordingRenderPass>(camera, stats);
+    }
+
+    std::unique_ptr<IBuffer> CreateBuffer(BufferUsage, const IDataProvider& data) override
+    {
+        return std::make_unique<RecordingBuffer>(data, stats);
+    }
+
+    std::unique_ptr<IStagingBuffer> CreateStagingBuffer(uint32_t size) override
+    {
+        return std::make_unique<RecordingStagingBuffer>(size, stats);
+    }
+
+    std::unique_ptr<IBuffer> CommitBuffer(BufferUsage, std::unique_ptr<IStagingBuffer> staging, uint32_t width) override
+    {
+        return std::make_unique<RecordingBuffer>(static_cast<uint32_t>(staging->GetData().size()), width, stats);
+    }
+
+    ITexture& CreateTexture(const IDataProvider&) override
+    {
+        ++stats.textures_created;
+        return textures.emplace_back();
+    }
+
+    IBuffer& AddBuffer(BufferUsage, const IDataProvider& data) override
+    {
+        return buffers.emplace_back(data, stats);
+    }
+
+    IVertexLayout& AddVertexLayout() override
+    {
+        return vertex_layouts.emplace_back();
+    }
+
+    ICommandBuffer& AddCommandBuffer(ICamera&) override
+    {
+        return command_buffers.emplace_back(stats);
+    }
+
+    IShader& CreateShader(const IDataProvider&, ShaderType) override
+    {
+        return shaders.emplace_back();
+    }
+
+    IDescriptorSet& CreateDescriptorSet(const InputResources&) override
+    {
+        return desc_sets.emplace_back();
+    }
+
+    IPipeline& CreatePipeline(const IDescriptorSet&, const Shaders&, const IVertexLayout&) override
+    {
+        return pipelines.emplace_back();
+    }
+
+private:
+    RecordingStats& stats;
+    uint32_t        frame_buffer_count = 0u;
+
+    std::deque<RecordingTexture>        textures;
+    std::deque<RecordingBuffer>         buffers;
+    std::deque<RecordingVertexLayout>   vertex_layouts;
+    std::deque<RecordingShader>         shaders;
+    std::deque<RecordingDescriptorSet>  desc_sets;
+    std::deque<RecordingPipeline>       pipelines;
+    std::deque<RecordingCommandBuffer>  command_buffers;
+};
+
+}
+
+}
+
+std::unique_ptr<Vulkan::IFactory> CreateRecordingFactory(Vulkan::RecordingStats& stats, uint32_t frame_buffer_count)
+{
+    return std::make_unique<Vulkan::RecordingFactory>(stats, frame_buffer_count);
+}
@@ -7,6 +7,8 @@
 #include "DescriptorSet.h"
 #include "Pipeline.h"
 #include "Camera.h"
+#include "RetireQueue.h"
+#include "UploadBatch.h"
 
 #include <Windows.h>
 
@@ -22,10 +24,27 @@ CameraRaii& GetCam(ICamera& camera)
     return *camera_raii;
 }
 
-RenderPass::RenderPass(ICamera& camera, const QVulkanWindow& wnd)
+void PushMvp(QVulkanDeviceFunctions& funcs, VkCommandBuffer cmd_buf, VkPipelineLayout layout, const CameraRaii& camera)
+{
+    auto mvp = camera.GetViewProjection();
+    const auto& mvp_layout = dynamic_cast<const PushConstantLayout&>(camera.GetMvpLayout());
+    funcs.vkCmdPushConstants(
+        cmd_buf,
+        layout,
+        VK_SHADER_STAGE_VERTEX_BIT,
+        mvp_layout.GetOffset(),
+        mvp_layout.GetSize(),
+        mvp.data()
+    );
+}
+
+RenderPass::RenderPass(ICamera& camera, const QVulkanWindow& wnd, UploadBatch& upload_batch, RetireQueue& retire_queue)
     : window(wnd)
     , camera_raii(GetCam(camera))
 {
+    // Hands the staging resources of the submitted copies to the retire queue, the fence of the frame follows them
+    upload_batch.Submit();
+    retire_queue.BeginFrame();
     camera_raii.BeforeRender();
     auto device = window.device();
     auto& device_functions = *window.vulkanInstance()->deviceFunctions(device);
@@ -136,8 +155,9 @@ void CommandBuffer::Bind(const IDescriptorSet& desc_set) const
 
     auto& dev_funcs = *window.vulkanInstance()->deviceFunctions(window.device());
     descriptor_set->Bind(dev_funcs, self_instances.at(window.currentFrame()));
+    current_layout = descriptor_set->GetPipelineLayout();
 
-    camera_raii.Push(dev_funcs, self_instances.at(window.currentFrame()), descriptor_set->GetPipelineLayout());
+    PushMvp(dev_funcs, self_instances.at(window.currentFrame()), descriptor_set->GetPipelineLayout(), camera_raii);
 }
 
 void CommandBuffer::Bind(const IPipeline& pip) const
@@ -147,6 +167,7 @@ void CommandBuffer::Bind(const IPipeline& pip) const
         throw std::logic_error("Unknown pipeline set derived");
 
     pipeline->Bind(self_instances.at(window.currentFrame()));
+    current_vertex_count = pipeline->GetVertexCount();
 
     const QSize size = window.swapChainImageSize();
     auto device = window.device();
@@ -182,9 +203,19 @@ void CommandBuffer::Draw(const IBuffer& buffer, uint32_t count, uint32_t offset)
     const auto& inst_buffer = dynamic_cast<const Buffer&>(buffer);
 
     auto& dev_funcs = *window.vulkanInstance()->deviceFunctions(window.device());
-    inst_buffer.Bind(self_instances.at(window.currentFrame()));
+    auto cmd_buf = self_instances.at(window.currentFrame());
+    auto instance_count = count > 0 ? count : inst_buffer.GetWidth();
+
+    // Pulled by the vertex shader, offset shifts gl_InstanceIndex and nothing is bound as vertex input
+    if (inst_buffer.GetUsage() == BufferUsage::Storage)
+    {
+        inst_buffer.BindStorage(cmd_buf, current_layout, storage_set_index);
+        dev_funcs.vkCmdDraw(cmd_buf, current_vertex_count, instance_count, 0, offset);
+        return;
+    }
 
-    dev_funcs.vkCmdDrawIndexed(self_instances.at(window.currentFrame()), current_index_count, count > 0 ? count : inst_buffer.GetWidth(), 0, 0, offset);
+    inst_buffer.Bind(cmd_buf);
+    dev_funcs.vkCmdDrawIndexed(cmd_buf, current_index_count, instance_count, 0, 0, offset);
 }
 
 void CommandBuffer::Flush() const
@@ -10,6 +10,8 @@ namespace Vulkan
 
 struct ICamera;
 struct CameraRaii;
+class RetireQueue;
+class UploadBatch;
 
 
 struct CommandBuffer
@@ -35,14 +37,17 @@ private:
     std::vector<VkCommandBuffer> self_instances;
     VkCommandPool command_pool = nullptr;
 
-    mutable uint32_t current_index_count = 0;
+    mutable uint32_t         current_index_count = 0;
+    mutable uint32_t         current_vertex_count = 0;
+    mutable VkPipelineLayout current_layout = nullptr;
 };
 
 class RenderPass
     : public IRenderPass
 {
 public:
-    RenderPass(ICamera& camera, const QVulkanWindow& wnd);
+    // Submits the uploads recorded so far and frees the resources whose frames are done before anything is recorded
+    RenderPass(ICamera& camera, const QVulkanWindow& wnd, UploadBatch& upload_batch, RetireQueue& retire_queue);
     void AddCommandBuffer(ICommandBuffer&) override;
     ~RenderPass() override;
 
@@ -0,0 +1,98 @@
+#include <Profiler.h>
+
+#include "RetireQueue.h"
+
+#include "Common.h"
+#include "Utils.h"
+
+namespace Vulkan
+{
+
+RetireQueue::RetireQueue(VulkanShared& vulkan)
+    : vulkan(vulkan)
+{
+}
+
+RetireQueue::~RetireQueue()
+{
+    vkDeviceWaitIdle(vulkan.device);
+    for (auto& batch : in_flight)
+    {
+        Free(batch.resources);
+        vkDestroyFence(vulkan.device, batch.fence, nullptr);
+    }
+    Free(retired);
+    for (auto fence : free_fences)
+        vkDestroyFence(vulkan.device, fence, nullptr);
+}
+
+void RetireQueue::Retire(const RetiredResource& resource)
+{
+    std::lock_guard lock(retired_mutex);
+    retired.push_back(resource);
+}
+
+void RetireQueue::BeginFrame()
+{
+    PROFILE_ZONE("RetireQueue::BeginFrame");
+    while (!in_flight.empty() && vkGetFenceStatus(vulkan.device, in_flight.front().fence) == VK_SUCCESS)
+    {
+        auto& batch = in_flight.front();
+        Free(batch.resources);
+        VkResultSuccess(vkResetFences(vulkan.device, 1, &batch.fence));
+        free_fences.push_back(batch.fence);
+        in_flight.pop_front();
+    }
+
+    Batch batch;
+    {
+        std::lock_guard lock(retired_mutex);
+        if (retired.empty())
+            return;
+        batch.resources.swap(retired);
+    }
+
+    // No command buffers, the fence signals once everything submitted before it is done
+    batch.fence = AcquireFence();
+    VkResultSuccess(vkQueueSubmit(vulkan.graphics_queue, 0, nullptr, batch.fence));
+    in_flight.push_back(std::move(batch));
+}
+
+void RetireQueue::Free(std::vector<RetiredResource>& resources) const
+{
+    for (const auto& resource : resources)
+    {
+        if (resource.storage_descriptor.set)
+            vulkan.storage_descriptors->Free(resource.storage_descriptor);
+        if (resource.view)
+            vkDestroyImageView(vulkan.device, resource.view, nullptr);
+        if (resource.sampler)
+            vkDestroySampler(vulkan.device, resource.sampler, nullptr);
+        if (resource.image)
+            vkDestroyImage(vulkan.device, resource.image, nullptr);
+        if (resource.buffer)
+            vkDestroyBuffer(vulkan.device, resource.buffer, nullptr);
+        if (resource.memory)
+            vkFreeMemory(vulkan.device, resource.memory, nullptr);
+    }
+    resources.clear();
+}
+
+VkFence RetireQueue::AcquireFence()
+{
+    if (!free_fences.empty())
+    {
+        auto res = free_fences.back();
+        free_fences.pop_back();
+        return res;
+    }
+
+    VkFenceCreateInfo fence_info = {};
+    fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+    VkFence res = nullptr;
+    VkResultSuccess(vkCreateFence(vulkan.device, &fence_info, nullptr, &res));
+    return res;
+}
+
+}
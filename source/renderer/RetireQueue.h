@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include "DescriptorSet.h"
+
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace Vulkan
+{
+
+struct VulkanShared;
+
+// Handles of a destroyed resource, the ones left null are skipped
+struct RetiredResource
+{
+    VkBuffer          buffer = nullptr;
+    VkImage           image = nullptr;
+    VkImageView       view = nullptr;
+    VkSampler         sampler = nullptr;
+    VkDeviceMemory    memory = nullptr;
+    StorageDescriptor storage_descriptor{};
+};
+
+// Resources destroyed while the GPU may still read them. Everything retired during a frame
+// is tagged with a fence submitted at the start of the next one, after the frame itself,
+// and the batch is freed once that fence signals.
+class RetireQueue
+{
+public:
+    explicit RetireQueue(VulkanShared& vulkan);
+    // Waits for the device and frees everything left
+    ~RetireQueue();
+
+    // Any thread
+    void Retire(const RetiredResource& resource);
+
+    // Render thread, before the frame is recorded
+    void BeginFrame();
+
+private:
+    struct Batch
+    {
+        VkFence                      fence = nullptr;
+        std::vector<RetiredResource> resources;
+    };
+
+    void Free(std::vector<RetiredResource>& resources) const;
+    VkFence AcquireFence();
+
+    VulkanShared& vulkan;
+
+    std::mutex                   retired_mutex;
+    std::vector<RetiredResource> retired;
+
+    std::deque<Batch>    in_flight;
+    std::vector<VkFence> free_fences;
+};
+
+}
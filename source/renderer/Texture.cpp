@@ -1,42 +1,30 @@
+#include <Profiler.h>
+
 #include "Texture.h"
 #include "Common.h"
 #include "Utils.h"
 
-#include "ScopeCommandBuffer.h"
-#include "MappedData.h"
+#include "Buffer.h"
+#include "RetireQueue.h"
+#include "UploadBatch.h"
 
+#include <algorithm>
+#include <stdexcept>
 #include <vector>
 
 namespace Vulkan
 {
     VkDeviceMemory Allocate(uint32_t index, VkDeviceSize size, VkDevice device);
 
-    Image CreateUploadImage(VkFormat format, uint32_t width, uint32_t height, VulkanShared& vulkan)
-    {
-        Image image{};
-
-        auto upload_info = GetImageCreateInfo(format, width, height);
-        upload_info.tiling = VK_IMAGE_TILING_LINEAR;
-        upload_info.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
-        VkResultSuccess(vkCreateImage(vulkan.device, &upload_info, nullptr, &image.image));
-
-        VkMemoryRequirements memory_requiments = {};
-        vkGetImageMemoryRequirements(vulkan.device, image.image, &memory_requiments);
-        image.memory = Allocate(vulkan.host_memory_index, memory_requiments.size, vulkan.device);
-
-        VkResultSuccess(vkBindImageMemory(vulkan.device, image.image, image.memory, 0));
-
-        return image;
-    }
-
-    Image CreateImage(VkFormat format, uint32_t width, uint32_t height, uint32_t depth, VulkanShared& vulkan)
+    Image CreateImage(VkFormat format, const IDataProvider& data, VulkanShared& vulkan)
     {
         Image image{};
 
-        auto image_info = GetImageCreateInfo(format, width, height);
+        auto image_info = GetImageCreateInfo(format, data.GetWidth(), data.GetHeight());
         image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
         image_info.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
-        image_info.arrayLayers = depth;
+        image_info.mipLevels = data.GetMipLevels();
+        image_info.arrayLayers = data.GetDepth();
         VkResultSuccess(vkCreateImage(vulkan.device, &image_info, nullptr, &image.image));
 
         VkMemoryRequirements memory_requiments = {};
@@ -48,80 +36,74 @@ namespace Vulkan
         return image;
     }
 
-    void CopyImage(const std::vector<Image>& srcs, const Image& dst, const VkExtent3D& extent, VulkanShared& vulkan)
+    // Every level of every layer in one copy, one region per level as the layers of a level are adjacent
+    void CopyLevels(const StagingBuffer& src, const Image& dst, const IDataProvider& data, VulkanShared& vulkan)
     {
-        ScopeCommandBuffer command_bufer(vulkan);
-
-        VkImageSubresourceRange subresourceRange = {};
-        subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        subresourceRange.baseMipLevel = 0;
-        subresourceRange.levelCount = 1;
-        subresourceRange.layerCount = 1;
+        auto& upload_batch = *vulkan.upload_batch;
 
         VkImageMemoryBarrier barrier = {};
         barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
         barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        barrier.subresourceRange.levelCount = barrier.subresourceRange.layerCount = 1;
-        barrier.oldLayout = VK_IMAGE_LAYOUT_PREINITIALIZED;
-        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-        barrier.srcAccessMask = VK_ACCESS_HOST_WRITE_BIT;
-        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-        for (const auto& src : srcs)
-        {
-            barrier.image = src.image;
-            command_bufer.TransferBarrier(VK_PIPELINE_STAGE_HOST_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, barrier);
-        }
-
-        barrier.subresourceRange.layerCount = static_cast<uint32_t>(srcs.size());
+        barrier.subresourceRange.levelCount = data.GetMipLevels();
+        barrier.subresourceRange.layerCount = data.GetDepth();
         barrier.oldLayout = VK_IMAGE_LAYOUT_PREINITIALIZED;
         barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
         barrier.srcAccessMask = 0;
         barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
         barrier.image = dst.image;
 
-        command_bufer.TransferBarrier(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, barrier);
-
-        VkImageCopy copy_info = {};
-        copy_info.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        copy_info.srcSubresource.layerCount = 1;
-        copy_info.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        copy_info.dstSubresource.layerCount = 1;
-        copy_info.extent = extent;
+        upload_batch.TransferBarrier(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, barrier);
 
-        for (uint32_t i = 0; i < srcs.size(); ++i)
+        std::vector<VkBufferImageCopy> regions(data.GetMipLevels());
+        VkDeviceSize offset = 0;
+        for (uint32_t level = 0; level < regions.size(); ++level)
         {
-            copy_info.dstSubresource.baseArrayLayer = i;
-            command_bufer.CopyImage(srcs[i].image, dst.image, copy_info);
+            auto& region = regions[level];
+            region.bufferOffset = offset;
+            region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.mipLevel = level;
+            region.imageSubresource.layerCount = data.GetDepth();
+            region.imageExtent = {
+                std::max(data.GetWidth() >> level, 1u),
+                std::max(data.GetHeight() >> level, 1u),
+                1u
+            };
+            offset += VkDeviceSize(region.imageExtent.width) * region.imageExtent.height * data.GetDepth() * 4u;
         }
+        if (offset != data.GetSize())
+            throw std::out_of_range("Texture data does not match its mip levels");
+
+        upload_batch.CopyBufferToImage(src.GetBuffer(), dst.image, regions);
 
         barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
         barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
         barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
         barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-        barrier.image = dst.image;
 
-        command_bufer.TransferBarrier(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, barrier);
+        upload_batch.ReleaseImage(barrier);
     }
 
-    VkSampler CreateSampler(VulkanShared& vulkan)
+    VkSampler CreateSampler(uint32_t levels, VulkanShared& vulkan)
     {
         VkSampler res = nullptr;
         auto info = GetSamplerCreateInfo();
+        info.maxLod = static_cast<float>(levels);
         VkResultSuccess(vkCreateSampler(
             vulkan.device, &info, nullptr, &res
         ));
         return res;
     }
 
-    VkImageView CreateImageView(VkImage image, uint32_t depth, VkFormat format, VulkanShared& vulkan)
+    VkImageView CreateImageView(VkImage image, const IDataProvider& data, VkFormat format, VulkanShared& vulkan)
     {
         VkImageView res = nullptr;
         auto view = GetImageViewCreateInfo(
             image,
-            depth > 1 ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D,
+            data.GetDepth() > 1 ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D,
             format
         );
-        view.subresourceRange.layerCount = depth;
+        view.subresourceRange.layerCount = data.GetDepth();
+        view.subresourceRange.levelCount = data.GetMipLevels();
         VkResultSuccess(vkCreateImageView(
             vulkan.device, &view, nullptr, &res
         ));
@@ -130,32 +112,17 @@ namespace Vulkan
 
     Texture::Texture(const IDataProvider& data, VulkanShared& vulkan, VkFormat format)
         : vulkan(vulkan)
-        , image(CreateImage(format, data.GetWidth(), data.GetHeight(), data.GetDepth(), vulkan))
-        , sampler(CreateSampler(vulkan))
-        , view(CreateImageView(image.image, data.GetDepth(), format, vulkan))
+        , image(CreateImage(format, data, vulkan))
+        , sampler(CreateSampler(data.GetMipLevels(), vulkan))
+        , view(CreateImageView(image.image, data, format, vulkan))
     {
-        auto data_ptr = data.GetData();
-        auto layer_size = data.GetWidth() * data.GetHeight() * 4;
-        std::vector<Image> uploads;
-        for (uint32_t layer = 0; layer < data.GetDepth(); ++layer)
-        {
-            uploads.emplace_back(CreateUploadImage(format, data.GetWidth(), data.GetHeight(), vulkan));
-            auto& upload_image = uploads.back();
-            {
-                MappedData mapped_data(upload_image, vulkan);
-                memcpy(mapped_data.GetData(), data_ptr, layer_size);
-            }
-            data_ptr += layer_size;
-        }
+        PROFILE_ZONE("Texture upload");
+        // Retired when it goes out of scope, the copy runs with the next upload batch
+        StagingBuffer staging(data.GetSize(), vulkan);
+        memcpy_s(staging.GetData().data(), staging.GetSize(), data.GetData(), data.GetSize());
+        staging.Flush();
 
-        VkExtent3D extent = { data.GetWidth(), data.GetHeight(), 1 };
-        CopyImage(uploads, image, extent, vulkan);
-
-        for (const auto& upload : uploads)
-        {
-            vkDestroyImage(vulkan.device, upload.image, nullptr);
-            vkFreeMemory(vulkan.device, upload.memory, nullptr);
-        }
+        CopyLevels(staging, image, data, vulkan);
     }
 
     VkDescriptorImageInfo Texture::GetInfo() const
@@ -169,9 +136,11 @@ namespace Vulkan
 
     Texture::~Texture()
     {
-        vkDestroyImage(vulkan.device, image.image, nullptr);
-        vkFreeMemory(vulkan.device, image.memory, nullptr);
-        vkDestroySampler(vulkan.device, sampler, nullptr);
-        vkDestroyImageView(vulkan.device, view, nullptr);
+        vulkan.retire_queue->Retire({
+            .image   = image.image,
+            .view    = view,
+            .sampler = sampler,
+            .memory  = image.memory,
+        });
     }
 }
@@ -0,0 +1,204 @@
+#include <Profiler.h>
+
+#include "UploadBatch.h"
+
+#include "RetireQueue.h"
+#include "Common.h"
+#include "Utils.h"
+
+namespace Vulkan
+{
+
+UploadBatch::UploadBatch(VulkanShared& vulkan, uint32_t queue_family_index)
+    : vulkan(vulkan)
+{
+    VkCommandPoolCreateInfo pool_info{};
+    pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    pool_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    pool_info.queueFamilyIndex = queue_family_index;
+    VkResultSuccess(vkCreateCommandPool(vulkan.device, &pool_info, nullptr, &command_pool));
+}
+
+UploadBatch::~UploadBatch()
+{
+    vkDeviceWaitIdle(vulkan.device);
+    for (const auto& resource : retired)
+        vulkan.retire_queue->Retire(resource);
+    if (recording.fence)
+        free_slots.push_back(recording);
+    for (const auto& slot : in_flight)
+        free_slots.push_back(slot);
+    for (const auto& slot : free_slots)
+        vkDestroyFence(vulkan.device, slot.fence, nullptr);
+    // Frees the command buffers with it
+    vkDestroyCommandPool(vulkan.device, command_pool, nullptr);
+}
+
+void UploadBatch::TransferBarrier(VkPipelineStageFlagBits stage_before, VkPipelineStageFlagBits stage_after, const VkImageMemoryBarrier& barrier)
+{
+    std::lock_guard lock(mutex);
+    vkCmdPipelineBarrier(
+        Record(),
+        stage_before,
+        stage_after,
+        0, 0, nullptr, 0, nullptr,
+        1, &barrier
+    );
+}
+
+void UploadBatch::CopyBufferToImage(VkBuffer src, VkImage dst, std::span<const VkBufferImageCopy> regions)
+{
+    if (regions.empty())
+        return;
+
+    std::lock_guard lock(mutex);
+    vkCmdCopyBufferToImage(
+        Record(),
+        src,
+        dst, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        static_cast<uint32_t>(regions.size()),
+        regions.data()
+    );
+}
+
+void UploadBatch::CopyBuffer(VkBuffer src, VkBuffer dst, std::span<const VkBufferCopy> regions)
+{
+    if (regions.empty())
+        return;
+
+    std::lock_guard lock(mutex);
+    vkCmdCopyBuffer(
+        Record(),
+        src,
+        dst,
+        static_cast<uint32_t>(regions.size()),
+        regions.data()
+    );
+    has_buffer_copies = true;
+}
+
+void UploadBatch::ReleaseImage(const VkImageMemoryBarrier& barrier)
+{
+    std::lock_guard lock(mutex);
+    Record();
+    image_releases.push_back(barrier);
+}
+
+void UploadBatch::Retire(const RetiredResource& resource)
+{
+    std::lock_guard lock(mutex);
+    retired.push_back(resource);
+}
+
+void UploadBatch::Submit()
+{
+    PROFILE_ZONE("UploadBatch::Submit");
+    std::lock_guard lock(mutex);
+    if (!recording.command_buffer)
+    {
+        // Their copies, if any, went with an earlier submit
+        HandOverRetired();
+        return;
+    }
+
+    // Vertex, index and storage data of every buffer copied this frame in one go, images with their own layouts
+    VkMemoryBarrier buffer_barrier = {};
+    buffer_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    buffer_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    buffer_barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+
+    VkPipelineStageFlags stage_after = 0;
+    if (has_buffer_copies)
+        stage_after |= VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT;
+    if (!image_releases.empty())
+        stage_after |= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+
+    if (stage_after)
+    {
+        vkCmdPipelineBarrier(
+            recording.command_buffer,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            stage_after,
+            0,
+            has_buffer_copies ? 1 : 0, &buffer_barrier,
+            0, nullptr,
+            static_cast<uint32_t>(image_releases.size()), image_releases.data()
+        );
+    }
+    VkResultSuccess(vkEndCommandBuffer(recording.command_buffer));
+
+    VkSubmitInfo submit_info = {};
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers = &recording.command_buffer;
+    VkResultSuccess(vkQueueSubmit(vulkan.graphics_queue, 1, &submit_info, recording.fence));
+
+    in_flight.push_back(recording);
+    recording = {};
+    image_releases.clear();
+    has_buffer_copies = false;
+    HandOverRetired();
+}
+
+void UploadBatch::HandOverRetired()
+{
+    for (const auto& resource : retired)
+        vulkan.retire_queue->Retire(resource);
+    retired.clear();
+}
+
+VkCommandBuffer UploadBatch::Record()
+{
+    if (recording.command_buffer)
+        return recording.command_buffer;
+
+    recording = AcquireSlot();
+
+    VkCommandBufferBeginInfo begin_info{};
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    VkResultSuccess(vkBeginCommandBuffer(recording.command_buffer, &begin_info));
+
+    // Buffers updated in place may still be read by the frames in flight, the copies wait for their draws
+    vkCmdPipelineBarrier(
+        recording.command_buffer,
+        VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0, 0, nullptr, 0, nullptr, 0, nullptr
+    );
+    return recording.command_buffer;
+}
+
+UploadBatch::Slot UploadBatch::AcquireSlot()
+{
+    while (!in_flight.empty() && vkGetFenceStatus(vulkan.device, in_flight.front().fence) == VK_SUCCESS)
+    {
+        auto slot = in_flight.front();
+        in_flight.pop_front();
+        VkResultSuccess(vkResetFences(vulkan.device, 1, &slot.fence));
+        VkResultSuccess(vkResetCommandBuffer(slot.command_buffer, 0));
+        free_slots.push_back(slot);
+    }
+
+    if (!free_slots.empty())
+    {
+        auto res = free_slots.back();
+        free_slots.pop_back();
+        return res;
+    }
+
+    Slot res;
+    VkCommandBufferAllocateInfo allocate_info{};
+    allocate_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocate_info.commandPool = command_pool;
+    allocate_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocate_info.commandBufferCount = 1;
+    VkResultSuccess(vkAllocateCommandBuffers(vulkan.device, &allocate_info, &res.command_buffer));
+
+    VkFenceCreateInfo fence_info = {};
+    fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    VkResultSuccess(vkCreateFence(vulkan.device, &fence_info, nullptr, &res.fence));
+    return res;
+}
+
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include "RetireQueue.h"
+
+#include <deque>
+#include <mutex>
+#include <span>
+#include <vector>
+
+namespace Vulkan
+{
+
+struct VulkanShared;
+
+// Transfers of one frame recorded into a single command buffer. It starts after the draws submitted
+// before it and Submit ends it with one barrier batch that makes every copy visible to the draws and hands it to the queue without waiting,
+// so staging resources are retired through it rather than destroyed once their copies are recorded.
+class UploadBatch
+{
+public:
+    UploadBatch(VulkanShared& vulkan, uint32_t queue_family_index);
+    // Waits for the device, copies recorded but never submitted are dropped
+    ~UploadBatch();
+
+    // Any thread, the commands run at the next Submit in recording order
+    void TransferBarrier(
+        VkPipelineStageFlagBits stage_before,
+        VkPipelineStageFlagBits stage_after,
+        const VkImageMemoryBarrier& barrier
+    );
+    void CopyBufferToImage(VkBuffer src, VkImage dst, std::span<const VkBufferImageCopy> regions);
+    void CopyBuffer(VkBuffer src, VkBuffer dst, std::span<const VkBufferCopy> regions);
+
+    // Any thread, moves an image from the transfer layout to the one it is sampled in after the copies
+    void ReleaseImage(const VkImageMemoryBarrier& barrier);
+
+    // Any thread, for the sources of recorded copies. They go to the retire queue only once the copies
+    // recorded so far are submitted, the fence tagging them then always comes after those copies
+    void Retire(const RetiredResource& resource);
+
+    // Render thread, before the frame using the uploads is submitted and before the retire queue starts it
+    void Submit();
+
+private:
+    struct Slot
+    {
+        VkCommandBuffer command_buffer = nullptr;
+        VkFence         fence = nullptr;
+    };
+
+    VkCommandBuffer Record();
+    Slot AcquireSlot();
+    // Under the mutex, right after a submit
+    void HandOverRetired();
+
+    VulkanShared& vulkan;
+    VkCommandPool command_pool = nullptr;
+
+    std::mutex                        mutex;
+    Slot                              recording;
+    std::vector<VkImageMemoryBarrier> image_releases;
+    bool                              has_buffer_copies = false;
+    std::vector<RetiredResource>      retired;
+
+    std::deque<Slot>  in_flight;
+    std::vector<Slot> free_slots;
+};
+
+}
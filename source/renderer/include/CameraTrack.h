@@ -0,0 +1,84 @@
+#pragma once
+
+#include <chrono>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "ICamera.h"
+
+namespace Vulkan
+{
+
+// Camera pose at a moment of a track, in the units of ICamera::SetPosition/SetRotation
+struct CameraKey
+{
+    double   time = 0.0; // seconds since the track start
+    Vector3f position;
+    Vector3f rotation;
+};
+
+// Timestamped camera poses. A text file with one key per line, the same track
+// replayed with the same time step gives the same camera every frame.
+class CameraTrack
+{
+public:
+    // Keys must come in non decreasing time
+    void Add(const CameraKey& key);
+
+    bool Empty() const;
+    double GetDuration() const;
+    const std::vector<CameraKey>& GetKeys() const;
+
+    // Linear between the surrounding keys, clamped to the first and last key
+    CameraKey Sample(double time) const;
+    void Apply(ICamera& camera, double time) const;
+
+    void Write(std::ostream& out) const;
+    // False on a malformed stream, the track is left empty then
+    bool Read(std::istream& in);
+
+    bool Save(const std::string& path) const;
+    bool Load(const std::string& path);
+
+private:
+    std::vector<CameraKey> keys;
+};
+
+// Adds the camera pose once per frame, timed with the wall clock
+class CameraRecorder
+{
+public:
+    void Start();
+    CameraTrack Stop();
+    bool IsRecording() const;
+
+    void OnFrame(const ICamera& camera);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    bool              recording = false;
+    Clock::time_point start;
+    CameraTrack       track;
+};
+
+// Frame n shows the track at n * time_step whatever the real frame time was
+class CameraPlayer
+{
+public:
+    CameraPlayer(CameraTrack track, double time_step);
+
+    // Moves the camera to the next frame, false once the track is over and the camera is left untouched
+    bool Step(ICamera& camera);
+    bool IsFinished() const;
+    uint64_t GetFrame() const;
+
+private:
+    CameraTrack track;
+    double      time_step = 0.0;
+    uint64_t    frame = 0u;
+};
+
+}
@@ -3,6 +3,7 @@
 #include "IRenderer.h"
 
 #include <vector>
+#include <span>
 
 namespace Vulkan
 {
@@ -39,4 +40,46 @@ public:
     uint32_t GetDepth()  const override { return 1u; }
 };
 
+// Range of items starting at item index first
+template <typename T>
+BufferRange MakeBufferRange(uint32_t first, std::span<const T> items)
+{
+    return {
+        .offset = static_cast<uint32_t>(first * sizeof(T)),
+        .data = { reinterpret_cast<const uint8_t*>(items.data()), items.size_bytes() },
+    };
+}
+
+template <typename T>
+class BufferDataView
+    : public IDataProvider
+{
+    std::span<const T> data;
+
+public:
+    explicit BufferDataView(std::span<const T> inst)
+        : data(inst)
+    {
+    }
+    ~BufferDataView() override = default;
+
+    uint32_t GetWidth() const override
+    {
+        return static_cast<uint32_t>(data.size());
+    }
+
+    const uint8_t* GetData() const override
+    {
+        return reinterpret_cast<const uint8_t*>(data.data());
+    }
+
+    uint32_t GetSize() const override
+    {
+        return GetWidth() * sizeof(T);
+    }
+
+    uint32_t GetHeight() const override { return 1u; }
+    uint32_t GetDepth()  const override { return 1u; }
+};
+
 }
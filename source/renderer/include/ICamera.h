@@ -3,6 +3,8 @@
 #include <memory>
 #include <cstdint>
 #include <string>
+#include <span>
+#include <array>
 
 namespace Vulkan
 {
@@ -36,6 +38,13 @@ struct BBox
     float max_z = 0.f;
 };
 
+enum class Visibility : uint32_t
+{
+    Outside = 0,
+    Intersects,
+    Inside,
+};
+
 struct Vector3f
 {
     float x = 0.f;
@@ -55,8 +64,16 @@ struct ICamera
     virtual void OnMouseMove(int32_t x, int32_t y, MouseButtons buttons) = 0;
 
     virtual bool ObjectVisible(const BBox& bbox) const = 0;
+    virtual Visibility ClassifyBox(const BBox& bbox) const = 0;
+    // Bit i % 64 of visible[i / 64] is set when boxes[i] is visible, visible must hold (size + 63) / 64 words
+    virtual void CullBoxes(std::span<const BBox> boxes, std::span<uint64_t> visible) const = 0;
 
     virtual Vector3f GetViewPos() const = 0;
+    // As last passed to SetPosition/SetRotation or reached by the key and mouse controls
+    virtual Vector3f GetPosition() const = 0;
+    virtual Vector3f GetRotation() const = 0;
+    // Column major, the matrix pushed to the shaders for the current frame
+    virtual std::array<float, 16> GetViewProjection() const = 0;
     virtual const IPushConstantLayout& GetMvpLayout() const = 0;
     virtual const std::string& GetInfo() const = 0;
 
@@ -2,9 +2,11 @@
 
 #include "IRenderer.h"
 
+#include <atomic>
 #include <functional>
 #include <vector>
 #include <memory>
+#include <span>
 
 namespace Vulkan
 {
@@ -16,6 +18,22 @@ enum class BufferUsage
     Index = 0,
     Vertex,
     Instance,
+    // Instances the vertex shader reads by gl_InstanceIndex, bound by the draw instead of as vertex input
+    Storage,
+};
+
+// Mapped host memory a producer fills in place before it is committed into a device buffer
+struct IStagingBuffer
+{
+    virtual std::span<uint8_t> GetData() = 0;
+    virtual ~IStagingBuffer() = default;
+
+    template <typename T>
+    std::span<T> GetSpan()
+    {
+        auto data = GetData();
+        return { reinterpret_cast<T*>(data.data()), data.size() / sizeof(T) };
+    }
 };
 
 using Attributes = std::vector<AttributeFormat>;
@@ -30,6 +48,11 @@ struct IFactory
 
     virtual std::unique_ptr<IBuffer> CreateBuffer(BufferUsage usage, const IDataProvider&) = 0;
 
+    // Any thread. The memory is not initialized, the producer must write all of it.
+    virtual std::unique_ptr<IStagingBuffer> CreateStagingBuffer(uint32_t size) = 0;
+    // Render thread, copies the staging memory into a new buffer of width elements
+    virtual std::unique_ptr<IBuffer> CommitBuffer(BufferUsage usage, std::unique_ptr<IStagingBuffer> staging, uint32_t width) = 0;
+
     virtual ITexture& CreateTexture(const IDataProvider&) = 0;
     virtual IBuffer& AddBuffer(BufferUsage usage, const IDataProvider&) = 0;
     virtual IVertexLayout& AddVertexLayout() = 0;
@@ -41,7 +64,26 @@ struct IFactory
     virtual ~IFactory() = default;
 };
 
+// Counters of the recording factory, updated from any thread
+struct RecordingStats
+{
+    std::atomic<uint64_t> buffers_created = 0u;
+    std::atomic<uint64_t> buffers_alive = 0u;
+    std::atomic<uint64_t> buffer_bytes_alive = 0u;
+    std::atomic<uint64_t> buffer_updates = 0u;
+    std::atomic<uint64_t> staging_buffers_created = 0u;
+    std::atomic<uint64_t> bytes_uploaded = 0u;
+    std::atomic<uint64_t> textures_created = 0u;
+    std::atomic<uint64_t> render_passes = 0u;
+    std::atomic<uint64_t> draw_calls = 0u;
+    std::atomic<uint64_t> instances_drawn = 0u;
+};
+
 }
 
 class QVulkanWindow;
 std::unique_ptr<Vulkan::IFactory> CreateFactory(const QVulkanWindow&);
+
+// Never touches Vulkan, resources only count into stats, which must outlive the factory and its resources.
+// Render passes still drive the camera frame updates, so the real camera can be used headless.
+std::unique_ptr<Vulkan::IFactory> CreateRecordingFactory(Vulkan::RecordingStats& stats, uint32_t frame_buffer_count = 2u);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <span>
 
 namespace Vulkan
 {
@@ -27,6 +28,8 @@ struct IDataProvider
     virtual uint32_t GetWidth()  const = 0;
     virtual uint32_t GetHeight() const = 0;
     virtual uint32_t GetDepth()  const = 0;
+    // Textures only, smaller levels follow level 0 level by level with every layer of a level together
+    virtual uint32_t GetMipLevels() const { return 1u; }
     virtual ~IDataProvider() = default;
 };
 
@@ -40,9 +43,20 @@ struct ITexture : public IInputResource
     virtual ~ITexture() = 0 {}
 };
 
+// Bytes written at a byte offset of a buffer
+struct BufferRange
+{
+    uint32_t                 offset = 0u;
+    std::span<const uint8_t> data;
+};
+
 struct IBuffer
 {
     virtual void Update(const IDataProvider&) = 0;
+    // Only the given bytes are uploaded. Throws std::out_of_range for a range past the end
+    // of the buffer and std::invalid_argument for ranges that overlap.
+    virtual void Update(uint32_t offset, std::span<const uint8_t> data) = 0;
+    virtual void Update(std::span<const BufferRange> ranges) = 0;
     virtual ~IBuffer() = default;
 };
 
@@ -77,6 +91,8 @@ struct IVertexLayout
 {
     virtual IVertexBinding& AddVertexBinding() = 0;
     virtual IVertexBinding& AddInstanceBinding() = 0;
+    // Vertices of each instance drawn from a storage buffer, the shader builds them from gl_VertexIndex
+    virtual void SetVertexCount(uint32_t count) = 0;
     virtual ~IVertexLayout() = default;
 };
 
@@ -0,0 +1,86 @@
+#include "gtest/gtest.h"
+
+#include "Camera.h"
+
+#include <cmath>
+#include <numbers>
+
+using Vulkan::BBox;
+using Vulkan::Key;
+using Vulkan::Visibility;
+
+static BBox CreateBox(float x, float y, float z)
+{
+    return { x - 1.f, y - 1.f, z - 1.f, x + 1.f, y + 1.f, z + 1.f };
+}
+
+TEST(CameraTests, Perspective)
+{
+    auto camera = Vulkan::CreateRaiiCamera();
+    camera->SetPerspective(60.f, 2.f, 0.1f, 256.f);
+    camera->BeforeRender();
+
+    // Column major, y is flipped for Vulkan
+    auto mvp = camera->GetViewProjection();
+    float cotan = 1.f / std::tan(std::numbers::pi_v<float> / 6.f);
+    EXPECT_NEAR(mvp[0], cotan / 2.f, 1e-5f);
+    EXPECT_NEAR(mvp[5], -cotan, 1e-5f);
+    EXPECT_NEAR(mvp[10], -256.1f / 255.9f, 1e-5f);
+    EXPECT_NEAR(mvp[11], -1.f, 1e-5f);
+    EXPECT_NEAR(mvp[14], -2.f * 0.1f * 256.f / 255.9f, 1e-5f);
+    EXPECT_NEAR(mvp[15], 0.f, 1e-5f);
+}
+
+TEST(CameraTests, LooksDownNegativeZ)
+{
+    auto camera = Vulkan::CreateRaiiCamera();
+    camera->SetPerspective(60.f, 1.f, 0.1f, 256.f);
+    camera->BeforeRender();
+
+    EXPECT_TRUE(camera->ObjectVisible(CreateBox(0.f, 0.f, -10.f)));
+    EXPECT_EQ(camera->ClassifyBox(CreateBox(0.f, 0.f, -10.f)), Visibility::Inside);
+    EXPECT_FALSE(camera->ObjectVisible(CreateBox(0.f, 0.f, 10.f)));
+    EXPECT_EQ(camera->ClassifyBox(CreateBox(0.f, 0.f, 10.f)), Visibility::Outside);
+    EXPECT_FALSE(camera->ObjectVisible(CreateBox(0.f, 0.f, -300.f)));
+}
+
+TEST(CameraTests, Rotation)
+{
+    auto camera = Vulkan::CreateRaiiCamera();
+    camera->SetPerspective(60.f, 1.f, 0.1f, 256.f);
+    camera->SetRotation(0.f, 90.f, 0.f);
+    camera->BeforeRender();
+
+    EXPECT_TRUE(camera->ObjectVisible(CreateBox(10.f, 0.f, 0.f)));
+    EXPECT_FALSE(camera->ObjectVisible(CreateBox(0.f, 0.f, -10.f)));
+}
+
+TEST(CameraTests, PositionIsTheViewTranslation)
+{
+    auto camera = Vulkan::CreateRaiiCamera();
+    camera->SetPerspective(60.f, 1.f, 0.1f, 256.f);
+    camera->SetPosition(5.f, -20.f, 3.f);
+    camera->BeforeRender();
+
+    auto view_pos = camera->GetViewPos();
+    EXPECT_FLOAT_EQ(view_pos.x, -5.f);
+    EXPECT_FLOAT_EQ(view_pos.y, -20.f);
+    EXPECT_FLOAT_EQ(view_pos.z, -3.f);
+    // The eye sits at the view position
+    EXPECT_TRUE(camera->ObjectVisible(CreateBox(-5.f, -20.f, -13.f)));
+    EXPECT_FALSE(camera->ObjectVisible(CreateBox(0.f, 0.f, -10.f)));
+}
+
+TEST(CameraTests, MovesForward)
+{
+    auto camera = Vulkan::CreateRaiiCamera();
+    camera->SetPerspective(60.f, 1.f, 0.1f, 256.f);
+    camera->OnKeyPressed(Key::W);
+    camera->BeforeRender();
+    camera->AfterRender();
+
+    auto position = camera->GetPosition();
+    EXPECT_FLOAT_EQ(position.x, 0.f);
+    EXPECT_FLOAT_EQ(position.y, 0.f);
+    EXPECT_FLOAT_EQ(position.z, 2.f);
+}
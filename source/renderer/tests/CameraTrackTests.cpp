@@ -0,0 +1,159 @@
+#include "gtest/gtest.h"
+
+#include <CameraTrack.h>
+
+#include <sstream>
+
+using Vulkan::CameraKey;
+using Vulkan::CameraTrack;
+using Vulkan::Vector3f;
+
+// Keeps the last pose it was given
+struct PoseCamera
+    : public Vulkan::ICamera
+{
+    void SetPosition(float x, float y, float z) override { position = { x, y, z }; }
+    void SetRotation(float x, float y, float z) override { rotation = { x, y, z }; }
+    void SetPerspective(float, float, float, float) override {}
+    void UpdateAspectRatio(float) override {}
+
+    void OnKeyPressed(Vulkan::Key) override {}
+    void OnKeyReleased(Vulkan::Key) override {}
+    void OnMouseMove(int32_t, int32_t, Vulkan::MouseButtons) override {}
+
+    bool ObjectVisible(const Vulkan::BBox&) const override { return true; }
+    Vulkan::Visibility ClassifyBox(const Vulkan::BBox&) const override { return Vulkan::Visibility::Inside; }
+    void CullBoxes(std::span<const Vulkan::BBox>, std::span<uint64_t>) const override {}
+
+    Vector3f GetViewPos() const override { return position; }
+    Vector3f GetPosition() const override { return position; }
+    Vector3f GetRotation() const override { return rotation; }
+    std::array<float, 16> GetViewProjection() const override { return {}; }
+    const Vulkan::IPushConstantLayout& GetMvpLayout() const override { throw std::logic_error("Not used"); }
+    const std::string& GetInfo() const override { return info; }
+
+    Vector3f    position;
+    Vector3f    rotation;
+    std::string info;
+};
+
+static void ExpectPose(const CameraKey& key, const Vector3f& position, const Vector3f& rotation)
+{
+    EXPECT_FLOAT_EQ(key.position.x, position.x);
+    EXPECT_FLOAT_EQ(key.position.y, position.y);
+    EXPECT_FLOAT_EQ(key.position.z, position.z);
+    EXPECT_FLOAT_EQ(key.rotation.x, rotation.x);
+    EXPECT_FLOAT_EQ(key.rotation.y, rotation.y);
+    EXPECT_FLOAT_EQ(key.rotation.z, rotation.z);
+}
+
+static CameraTrack CreateTrack()
+{
+    CameraTrack track;
+    track.Add({ 2.0, { 0.f, 10.f, 0.f }, { 0.f, 90.f, 0.f } });
+    track.Add({ 3.0, { 4.f, 10.f, -2.f }, { -10.f, 180.f, 0.f } });
+    track.Add({ 5.0, { 4.f, 30.f, -2.f }, { -10.f, 180.f, 20.f } });
+    return track;
+}
+
+TEST(CameraTrackTests, SampleAtKeys)
+{
+    auto track = CreateTrack();
+    EXPECT_DOUBLE_EQ(track.GetDuration(), 3.0);
+
+    // Times are relative to the first key
+    ExpectPose(track.Sample(0.0), { 0.f, 10.f, 0.f }, { 0.f, 90.f, 0.f });
+    ExpectPose(track.Sample(1.0), { 4.f, 10.f, -2.f }, { -10.f, 180.f, 0.f });
+    ExpectPose(track.Sample(3.0), { 4.f, 30.f, -2.f }, { -10.f, 180.f, 20.f });
+}
+
+TEST(CameraTrackTests, SampleBetweenKeys)
+{
+    auto track = CreateTrack();
+    ExpectPose(track.Sample(0.25), { 1.f, 10.f, -0.5f }, { -2.5f, 112.5f, 0.f });
+    ExpectPose(track.Sample(2.0), { 4.f, 20.f, -2.f }, { -10.f, 180.f, 10.f });
+
+    // Clamped outside of the track
+    ExpectPose(track.Sample(-1.0), { 0.f, 10.f, 0.f }, { 0.f, 90.f, 0.f });
+    ExpectPose(track.Sample(10.0), { 4.f, 30.f, -2.f }, { -10.f, 180.f, 20.f });
+}
+
+TEST(CameraTrackTests, WriteReadRoundTrip)
+{
+    CameraTrack track;
+    track.Add({ 0.1, { 100.123456f, -0.000123f, 1e6f }, { 1.f / 3.f, 2.f / 3.f, -179.99f } });
+    track.Add({ 0.1 + 1.0 / 60.0, { 0.f, 0.f, 0.f }, { 0.f, 0.f, 0.f } });
+
+    std::stringstream stream;
+    track.Write(stream);
+
+    CameraTrack res;
+    ASSERT_TRUE(res.Read(stream));
+    ASSERT_EQ(res.GetKeys().size(), track.GetKeys().size());
+    for (size_t i = 0; i < track.GetKeys().size(); ++i)
+    {
+        const auto& expected = track.GetKeys()[i];
+        const auto& key = res.GetKeys()[i];
+        // Written with enough digits to read back the same values
+        EXPECT_EQ(key.time, expected.time);
+        EXPECT_EQ(key.position.x, expected.position.x);
+        EXPECT_EQ(key.position.y, expected.position.y);
+        EXPECT_EQ(key.position.z, expected.position.z);
+        EXPECT_EQ(key.rotation.x, expected.rotation.x);
+        EXPECT_EQ(key.rotation.y, expected.rotation.y);
+        EXPECT_EQ(key.rotation.z, expected.rotation.z);
+    }
+}
+
+TEST(CameraTrackTests, ReadMalformed)
+{
+    CameraTrack track;
+    std::stringstream wrong_header("camera_track 2\n0 0 0 0 0 0 0\n");
+    EXPECT_FALSE(track.Read(wrong_header));
+
+    std::stringstream backwards("camera_track 1\n1 0 0 0 0 0 0\n0.5 0 0 0 0 0 0\n");
+    EXPECT_FALSE(track.Read(backwards));
+    EXPECT_TRUE(track.Empty());
+
+    std::stringstream short_line("camera_track 1\n1 0 0 0 0 0\n");
+    EXPECT_FALSE(track.Read(short_line));
+}
+
+TEST(CameraTrackTests, PlayerFinishesAtTrackEnd)
+{
+    PoseCamera camera;
+    // Frames at 0, 1, 2 and 3 seconds, the last one lands on the last key
+    Vulkan::CameraPlayer player(CreateTrack(), 1.0);
+    for (uint64_t frame = 0; frame < 4; ++frame)
+    {
+        EXPECT_FALSE(player.IsFinished()) << frame;
+        EXPECT_TRUE(player.Step(camera)) << frame;
+    }
+    EXPECT_TRUE(player.IsFinished());
+    EXPECT_EQ(player.GetFrame(), 4u);
+    EXPECT_FLOAT_EQ(camera.GetPosition().y, 30.f);
+    EXPECT_FLOAT_EQ(camera.GetRotation().z, 20.f);
+
+    // The camera is left where the track ended
+    camera.SetPosition(0.f, 0.f, 0.f);
+    EXPECT_FALSE(player.Step(camera));
+    EXPECT_FLOAT_EQ(camera.GetPosition().y, 0.f);
+    EXPECT_EQ(player.GetFrame(), 4u);
+}
+
+TEST(CameraTrackTests, PlayerPastTrackEnd)
+{
+    PoseCamera camera;
+    // Frames at 0, 1.25, 2.5 and 3.75 seconds, the last one is clamped to the last key
+    Vulkan::CameraPlayer player(CreateTrack(), 1.25);
+    for (uint64_t frame = 0; frame < 4; ++frame)
+        EXPECT_TRUE(player.Step(camera)) << frame;
+    EXPECT_TRUE(player.IsFinished());
+    EXPECT_FLOAT_EQ(camera.GetPosition().y, 30.f);
+
+    Vulkan::CameraPlayer empty(CameraTrack{}, 1.0);
+    EXPECT_TRUE(empty.IsFinished());
+    EXPECT_FALSE(empty.Step(camera));
+
+    EXPECT_THROW(Vulkan::CameraPlayer(CreateTrack(), 0.0), std::invalid_argument);
+}
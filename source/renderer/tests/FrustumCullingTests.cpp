@@ -0,0 +1,109 @@
+#include "gtest/gtest.h"
+
+#include "FrustumCulling.h"
+
+#include <random>
+#include <vector>
+
+using Vulkan::BBox;
+using Vulkan::Visibility;
+
+// Cube from -10 to 10 on every axis, normals pointing inside, the near plane tilted
+static Vulkan::FrustumPlanes CreatePlanes()
+{
+    return { {
+        {  1.f,  0.f,  0.f, 10.f },
+        { -1.f,  0.f,  0.f, 10.f },
+        {  0.f,  1.f,  0.f, 10.f },
+        {  0.f, -1.f,  0.f, 10.f },
+        {  0.f,  0.2f, 1.f, 10.f },
+        {  0.f,  0.f, -1.f, 10.f },
+    } };
+}
+
+static BBox CreateBox(float x, float y, float z, float size)
+{
+    return { x, y, z, x + size, y + size, z + size };
+}
+
+static std::vector<bool> Cull(const Vulkan::FrustumPlanes& planes, const std::vector<BBox>& boxes)
+{
+    std::vector<uint64_t> visible((boxes.size() + 63) / 64, ~0ull);
+    Vulkan::CullBoxes(planes, boxes, visible);
+
+    std::vector<bool> res;
+    for (size_t i = 0; i < boxes.size(); ++i)
+        res.push_back((visible[i / 64] >> (i % 64)) & 1u);
+    return res;
+}
+
+TEST(FrustumCullingTests, Classify)
+{
+    auto planes = CreatePlanes();
+    EXPECT_EQ(Vulkan::ClassifyBox(planes, CreateBox(-1.f, -1.f, -1.f, 2.f)), Visibility::Inside);
+    EXPECT_EQ(Vulkan::ClassifyBox(planes, CreateBox(9.f, -1.f, -1.f, 2.f)), Visibility::Intersects);
+    EXPECT_EQ(Vulkan::ClassifyBox(planes, CreateBox(20.f, -1.f, -1.f, 2.f)), Visibility::Outside);
+    // Only the tilted plane rejects it
+    EXPECT_EQ(Vulkan::ClassifyBox(planes, CreateBox(-1.f, -9.f, -9.5f, 1.f)), Visibility::Outside);
+    EXPECT_EQ(Vulkan::ClassifyBox(planes, CreateBox(-1.f, 2.f, -10.5f, 1.f)), Visibility::Intersects);
+}
+
+TEST(FrustumCullingTests, BatchMatchesSingleBoxes)
+{
+    auto planes = CreatePlanes();
+    // Inside, intersecting and outside in every lane of a batch, then a tail of three boxes
+    std::vector<BBox> boxes = {
+        CreateBox(-1.f, -1.f, -1.f, 2.f),   CreateBox(9.f, -1.f, -1.f, 2.f),   CreateBox(20.f, -1.f, -1.f, 2.f), CreateBox(-1.f, -9.f, -9.5f, 1.f),
+        CreateBox(-12.f, -1.f, -1.f, 4.f),  CreateBox(-1.f, -1.f, -1.f, 2.f), CreateBox(-1.f, 2.f, -10.5f, 1.f), CreateBox(-1.f, -30.f, -1.f, 2.f),
+        CreateBox(-1.f, -1.f, 10.f, 2.f),   CreateBox(-11.f, -11.f, -11.f, 22.f), CreateBox(0.f, 0.f, 0.f, 0.f),
+    };
+    ASSERT_NE(boxes.size() % 4, 0u);
+
+    auto visible = Cull(planes, boxes);
+    for (size_t i = 0; i < boxes.size(); ++i)
+    {
+        EXPECT_EQ(visible[i], Vulkan::BoxVisible(planes, boxes[i])) << i;
+        EXPECT_EQ(visible[i], Vulkan::ClassifyBox(planes, boxes[i]) != Visibility::Outside) << i;
+    }
+
+    std::vector<bool> expected = { true, true, false, false, true, true, true, false, false, true, true };
+    EXPECT_EQ(visible, expected);
+}
+
+TEST(FrustumCullingTests, RandomBoxes)
+{
+    std::mt19937 random(17);
+    std::uniform_real_distribution<float> tilt(-0.3f, 0.3f);
+    std::uniform_real_distribution<float> position(-30.f, 30.f);
+    std::uniform_real_distribution<float> size(0.f, 15.f);
+
+    auto planes = CreatePlanes();
+    for (auto& plane : planes)
+    {
+        plane.x += tilt(random);
+        plane.y += tilt(random);
+        plane.z += tilt(random);
+    }
+
+    std::vector<BBox> boxes;
+    for (uint32_t i = 0; i < 1001; ++i)
+        boxes.push_back(CreateBox(position(random), position(random), position(random), size(random)));
+
+    auto visible = Cull(planes, boxes);
+    size_t visible_count = 0;
+    for (size_t i = 0; i < boxes.size(); ++i)
+    {
+        EXPECT_EQ(visible[i], Vulkan::BoxVisible(planes, boxes[i])) << i;
+        visible_count += visible[i];
+    }
+    // Both outcomes are covered
+    EXPECT_GT(visible_count, 0u);
+    EXPECT_LT(visible_count, boxes.size());
+}
+
+TEST(FrustumCullingTests, MaskTooSmall)
+{
+    std::vector<BBox> boxes(65);
+    std::vector<uint64_t> visible(1);
+    EXPECT_THROW(Vulkan::CullBoxes(CreatePlanes(), boxes, visible), std::invalid_argument);
+}
@@ -0,0 +1,76 @@
+#include "gtest/gtest.h"
+
+#include <DataProvider.h>
+#include <IFactory.h>
+
+#include <array>
+#include <stdexcept>
+
+using Vulkan::BufferRange;
+using Vulkan::MakeBufferRange;
+
+class RecordingBufferTests : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        factory = CreateRecordingFactory(stats);
+        buffer = factory->CreateBuffer(Vulkan::BufferUsage::Storage, Vulkan::BufferDataOwner<uint32_t>(items));
+    }
+
+    std::vector<uint32_t> items = std::vector<uint32_t>(16, 0u);
+
+    Vulkan::RecordingStats             stats;
+    std::unique_ptr<Vulkan::IFactory>  factory;
+    std::unique_ptr<Vulkan::IBuffer>   buffer;
+};
+
+TEST_F(RecordingBufferTests, SubRangeUploadsItsBytes)
+{
+    auto created_bytes = stats.bytes_uploaded.load();
+    std::array<uint32_t, 3> patch = { 1u, 2u, 3u };
+    auto range = MakeBufferRange<uint32_t>(4u, patch);
+    buffer->Update(range.offset, range.data);
+
+    EXPECT_EQ(range.offset, 4u * sizeof(uint32_t));
+    EXPECT_EQ(stats.buffer_updates, 1u);
+    EXPECT_EQ(stats.bytes_uploaded - created_bytes, sizeof(patch));
+}
+
+TEST_F(RecordingBufferTests, RangesUploadOnlyTheirBytes)
+{
+    auto created_bytes = stats.bytes_uploaded.load();
+    std::array<uint32_t, 2> first = { 1u, 2u };
+    std::array<uint32_t, 3> second = { 3u, 4u, 5u };
+    // Any order, ranges may touch but not overlap
+    std::array<BufferRange, 3> ranges = {
+        MakeBufferRange<uint32_t>(13u, second),
+        MakeBufferRange<uint32_t>(0u, first),
+        MakeBufferRange<uint32_t>(2u, std::span<const uint32_t>()),
+    };
+    buffer->Update(ranges);
+
+    EXPECT_EQ(stats.buffer_updates, 1u);
+    EXPECT_EQ(stats.bytes_uploaded - created_bytes, sizeof(first) + sizeof(second));
+}
+
+TEST_F(RecordingBufferTests, RangePastTheEndThrows)
+{
+    std::array<uint32_t, 2> patch = { 1u, 2u };
+    auto range = MakeBufferRange<uint32_t>(15u, patch);
+    EXPECT_THROW(buffer->Update(range.offset, range.data), std::out_of_range);
+
+    auto last = MakeBufferRange<uint32_t>(14u, patch);
+    EXPECT_NO_THROW(buffer->Update(last.offset, last.data));
+}
+
+TEST_F(RecordingBufferTests, OverlappingRangesThrow)
+{
+    std::array<uint32_t, 4> first = {};
+    std::array<uint32_t, 2> second = {};
+    std::array<BufferRange, 2> ranges = {
+        MakeBufferRange<uint32_t>(6u, second),
+        MakeBufferRange<uint32_t>(3u, first),
+    };
+    EXPECT_THROW(buffer->Update(ranges), std::invalid_argument);
+}
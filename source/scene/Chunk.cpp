@@ -1,191 +1,178 @@
-#include <DataProvider.h>
 #include <IFactory.h>
+#include <ICamera.h>
+#include <DataProvider.h>
 
 #include <Noise.h>
 
 #include "Chunk.h"
-#include "Texture.h"
-#include "IResourceLoader.h"
+#include "ChunkMesher.h"
+#include "Structures.h"
 #include "ThreadUtils.hpp"
 
-namespace Scene
-{
-
-constexpr int32_t g_chunk_size = 32;
-constexpr uint32_t g_grass_bottom = 57;
-constexpr uint32_t g_grass_top = 78;
+#include <cstring>
+#include <limits>
 
-enum class CubeFace : uint32_t
-{
-    front = 0,
-    back,
-    left,
-    right,
-    top,
-    bottom,
-    count,
-};
-
-struct CubeInstance
+namespace Scene
 {
-    float    pos[3];
-    uint32_t texture;
-    CubeFace face;
-};
 
-CubeInstance CreateFace(int32_t x, int32_t y, int32_t z, CubeFace face, TextureType type)
+ChunkTerrainPtr CreateTerrain(const utils::vec2i& base, INoise& noiser, StructureCache& structures)
 {
-    CubeInstance cube = {};
-    cube.pos[0] = static_cast<float>(x);
-    cube.pos[1] = static_cast<float>(y);
-    cube.pos[2] = static_cast<float>(z);
-    cube.face = static_cast<CubeFace>(face);
-    cube.texture = static_cast<uint32_t>(type);
-    return cube;
-}
+    constexpr int32_t padded_size = g_chunk_size + 2;
 
-CubeInstance CreateFace(int32_t x, int32_t y, int32_t z, CubeFace face)
-{
-    if (y > 84)
-        return CreateFace(x,y, z, face, TextureType::Snow);
-    else if (y > g_grass_top)
-        return CreateFace(x, y, z, face, TextureType::Stone);
-    else if (y > g_grass_bottom)
-        return CreateFace(x, y, z, face, face == CubeFace::top ? TextureType::GrassBlockTop :TextureType::GrassBlockSide);
-
-    return CreateFace(x, y, z, face, TextureType::Sand);
+    auto terrain = std::make_shared<ChunkTerrain>();
+    terrain->heights.resize(padded_size * padded_size);
+    for (int32_t x_offset = -1; x_offset <= g_chunk_size; ++x_offset)
+    {
+        for (int32_t z_offset = -1; z_offset <= g_chunk_size; ++z_offset)
+        {
+            auto x = base.x * g_chunk_size + x_offset;
+            auto z = base.y * g_chunk_size + z_offset;
+            int32_t y = noiser.GetHeight(x, z);
+            terrain->heights[(x_offset + 1) * padded_size + z_offset + 1] = y;
+        }
+    }
+    terrain->structures = structures.Query(base);
+    return terrain;
 }
 
-void AddTree(int32_t x, int32_t y, int32_t z, std::vector<CubeInstance>& cubes)
+// The lowest column of a cell, so the occluder never covers more than the real terrain.
+// Removed blocks dig into the ground and lower the cell to the deepest hole.
+static void FillOccluderHeights(const utils::vec2i& base, const ChunkTerrain& terrain, const BlockEdits& edits, std::array<int32_t, Chunk::occluder_cells * Chunk::occluder_cells>& heights)
 {
-    constexpr int32_t height = 5;
-    constexpr int32_t rad = 2;
-    for (int i = 0; i < height; ++i)
-    {
-        cubes.emplace_back(CreateFace(x, y + i, z, CubeFace::front, TextureType::OakLog));
-        cubes.emplace_back(CreateFace(x, y + i, z, CubeFace::back, TextureType::OakLog));
-        cubes.emplace_back(CreateFace(x, y + i, z, CubeFace::left, TextureType::OakLog));
-        cubes.emplace_back(CreateFace(x, y + i, z, CubeFace::right, TextureType::OakLog));
-    }
+    constexpr int32_t padded_size = g_chunk_size + 2;
+    constexpr int32_t cell_size = g_chunk_size / Chunk::occluder_cells;
 
-    for (int i = -rad; i <= rad; ++i)
+    heights.fill(std::numeric_limits<int32_t>::max());
+    for (int32_t x_offset = 0; x_offset < g_chunk_size; ++x_offset)
     {
-        for (int j = -rad; j <= rad; ++j)
+        for (int32_t z_offset = 0; z_offset < g_chunk_size; ++z_offset)
         {
-            for (int k = 0; k < 3; ++k)
-            {
-                if (k == 2 && (std::abs(i) > 1 || std::abs(j) > 1))
-                    continue;
-                cubes.emplace_back(CreateFace(x + i, y + 3 + k, z + j, CubeFace::front, TextureType::LeavesOakOpaque));
-                cubes.emplace_back(CreateFace(x + i, y + 3 + k, z + j, CubeFace::back,  TextureType::LeavesOakOpaque));
-                cubes.emplace_back(CreateFace(x + i, y + 3 + k, z + j, CubeFace::left,  TextureType::LeavesOakOpaque));
-                cubes.emplace_back(CreateFace(x + i, y + 3 + k, z + j, CubeFace::right, TextureType::LeavesOakOpaque));
-            }
-
-            int add = !(std::abs(i) > 1 || std::abs(j) > 1);
-            cubes.emplace_back(CreateFace(x + i, y + 3, z + j, CubeFace::bottom, TextureType::LeavesOakOpaque));
-            cubes.emplace_back(CreateFace(x + i, y + 4 + add, z + j, CubeFace::top, TextureType::LeavesOakOpaque));
-
-            if (i == x && j == z)
-                continue;
+            auto& cell = heights[(x_offset / cell_size) * Chunk::occluder_cells + z_offset / cell_size];
+            cell = std::min(cell, terrain.heights[(x_offset + 1) * padded_size + z_offset + 1] + 1);
         }
     }
 
-    cubes.emplace_back(CreateFace(x, y + height - 1, z, CubeFace::top, TextureType::OakLogTop));
+    for (const auto& [pos, block] : edits)
+    {
+        auto x_offset = pos.x - base.x * g_chunk_size;
+        auto z_offset = pos.z - base.y * g_chunk_size;
+        if (block || x_offset < 0 || x_offset >= g_chunk_size || z_offset < 0 || z_offset >= g_chunk_size)
+            continue;
 
+        auto& cell = heights[(x_offset / cell_size) * Chunk::occluder_cells + z_offset / cell_size];
+        cell = std::min(cell, pos.y);
+    }
 }
 
-Chunk::Chunk(const utils::vec2i& base, Vulkan::IFactory& factory, INoise& noiser, utils::DefferedExecutor& pool)
+Chunk::Chunk(const utils::vec2i& base, uint32_t lod, Vulkan::IFactory& factory, INoise& noiser, StructureCache& structures, utils::DefferedExecutor& pool, const BlockEdits& edits)
+    : Chunk(base, lod, CreateTerrain(base, noiser, structures), factory, pool, edits)
+{
+}
+
+Chunk::Chunk(const utils::vec2i& base, uint32_t lod, ChunkTerrainPtr terrain_data, Vulkan::IFactory& factory, utils::DefferedExecutor& pool, const BlockEdits& edits)
     : base_point(base)
+    , lod(lod)
+    , terrain(std::move(terrain_data))
+    , factory(factory)
     , task_queue(pool)
-    , frame_buffer_count(factory.GetFrameBufferCount())
 {
-    auto size = g_chunk_size;
-    bbox.first.x = base_point.x * size;
-    bbox.first.z = base_point.y * size;
-    bbox.first.y = std::numeric_limits<decltype(bbox.first.y)>::max();
-    bbox.second.x = base_point.x * size + size;
-    bbox.second.z = base_point.y * size + size;
-    bbox.second.y = 0;
-
-    std::vector<CubeInstance> cubes;
-    std::vector<CubeInstance> water;
-    for (int32_t x_offset = 0; x_offset < size; ++x_offset)
+    ChunkMesher mesher(base_point, lod, *terrain, edits);
+    bbox = mesher.GetBBox();
+
+    // Distant lods don't follow the terrain closely enough to occlude anything
+    if (lod == 0)
+        FillOccluderHeights(base_point, *terrain, edits, occluder_heights);
+
+    const auto& size = mesher.GetSize();
+    buffer_size = size.cubes;
+    water_size = size.water;
+    keeps_cubes = lod == 0 && !edits.empty();
+    buffer_capacity = keeps_cubes && buffer_size > 0 ? buffer_size + edit_spare_cubes : buffer_size;
+
+    if (buffer_capacity > 0)
+        staging = factory.CreateStagingBuffer(buffer_capacity * sizeof(CubeInstance));
+    if (water_size > 0)
+        water_staging = factory.CreateStagingBuffer(water_size * sizeof(CubeInstance));
+
+    auto cube_span = staging ? staging->GetSpan<CubeInstance>().first(buffer_size) : std::span<CubeInstance>();
+    mesher.Write(cube_span, water_staging ? water_staging->GetSpan<CubeInstance>() : std::span<CubeInstance>());
+    if (keeps_cubes)
+        cubes.assign(cube_span.begin(), cube_span.end());
+
+    create_task = task_queue.Add(utils::DefferedExecutor::immediate, [this, &factory]() {
+        if (water_staging)
+            water_buffer = factory.CommitBuffer(Vulkan::BufferUsage::Storage, std::move(water_staging), water_size);
+        if (staging)
+            buffer = factory.CommitBuffer(Vulkan::BufferUsage::Storage, std::move(staging), buffer_size);
+        committed = true;
+    });
+}
+
+Chunk::~Chunk()
+{
+    // The renderer keeps the buffers alive until the frames using them are done
+    task_queue.Remove(create_task);
+}
+
+bool Chunk::Patch(Chunk& previous)
+{
+    if (!keeps_cubes || !previous.keeps_cubes || !previous.buffer || buffer_size > previous.buffer_capacity)
+        return false;
+
+    // Both run on the render thread, the commit task has either run already or never will
+    task_queue.Remove(create_task);
+    if (committed)
+        return false;
+
+    buffer = std::move(previous.buffer);
+    buffer_capacity = previous.buffer_capacity;
+    staging.reset();
+
+    auto changed = [&](size_t i) {
+        return i >= previous.cubes.size() || std::memcmp(&cubes[i], &previous.cubes[i], sizeof(CubeInstance)) != 0;
+    };
+
+    // Runs of changed cubes, a few unchanged cubes between two runs are uploaded too to keep the copies few
+    constexpr size_t merge_gap = 8;
+    std::vector<Vulkan::BufferRange> ranges;
+    size_t first = 0;
+    while (first < cubes.size())
     {
-        for (int32_t z_offset = 0; z_offset < size; ++z_offset)
+        if (!changed(first))
         {
-            auto x = base_point.x * size + x_offset;
-            auto z = base_point.y * size + z_offset;
-            int32_t y = noiser.GetHeight(x, z);
-            cubes.emplace_back(CreateFace(x, y, z, CubeFace::top));
-            if (noiser.IsTree(x, z) && cubes.back().texture == static_cast<uint32_t>(TextureType::GrassBlockTop))
-            {
-                //cubes.back().texture = static_cast<uint32_t>(TextureType::OakLog);
-                AddTree(x, y, z, cubes);
-            }
-
-
-            if (y < g_grass_bottom)
-            {
-                water.emplace_back(cubes.back());
-                water.back().texture = static_cast<uint32_t>(TextureType::WaterOverlay);
-                water.back().pos[1] = static_cast<float>(g_grass_bottom);
-            }
-
-            bbox.second.y = std::max(bbox.second.y, std::max(y + 1, static_cast<int32_t>(g_grass_bottom)));
-            while (y >= 0)
-            {
-                auto before = cubes.size();
-                if (noiser.GetHeight(x, z + 1) < y)
-                {
-                    cubes.emplace_back(CreateFace(x, y, z, CubeFace::front));
-                }
-                if (noiser.GetHeight(x, z - 1) < y)
-                {
-                    cubes.emplace_back(CreateFace(x, y, z, CubeFace::back));
-                }
-                if (noiser.GetHeight(x + 1, z) < y)
-                {
-                    cubes.emplace_back(CreateFace(x, y, z, CubeFace::right));
-                }
-                if (noiser.GetHeight(x - 1, z) < y)
-                {
-                    cubes.emplace_back(CreateFace(x, y, z, CubeFace::left));
-                }
-
-                if (before == cubes.size())
-                    break;
-
-                --y;
-            }
-            bbox.first.y = std::min(bbox.first.y, y);
+            ++first;
+            continue;
         }
+
+        size_t end = first + 1;
+        for (size_t i = end; i < cubes.size() && i - end < merge_gap; ++i)
+        {
+            if (changed(i))
+                end = i + 1;
+        }
+        auto run = std::span<const CubeInstance>(cubes).subspan(first, end - first);
+        ranges.emplace_back(Vulkan::MakeBufferRange(static_cast<uint32_t>(first), run));
+        first = end;
     }
-    if (cubes.empty())
-        cubes.emplace_back(CreateFace(0, 0, 0, CubeFace::front));
-
-    has_water = !water.empty();
-    water_offset = static_cast<uint32_t>(cubes.size());
-    cubes.insert(cubes.end(), water.begin(), water.end());
-    buffer_size = static_cast<uint32_t>(cubes.size());
-
-    create_id = task_queue.Add(utils::DefferedExecutor::immediate,
-        std::bind([this, &factory](const auto& cubes) {
-            buffer = factory.CreateBuffer(Vulkan::BufferUsage::Instance, Vulkan::BufferDataOwner<CubeInstance>(cubes));
-        }, std::move(cubes))
-    );
+    buffer->Update(ranges);
+
+    if (water_staging)
+        water_buffer = factory.CommitBuffer(Vulkan::BufferUsage::Storage, std::move(water_staging), water_size);
+    committed = true;
+    return true;
 }
 
-Chunk::~Chunk()
+void Chunk::Draw(const Vulkan::ICommandBuffer& command_buffer) const
 {
-    task_queue.Remove(create_id);
-    std::shared_ptr<Vulkan::IBuffer> to_release = std::move(buffer);
-    task_queue.Add(frame_buffer_count, [bp = to_release]() {});
+    // The buffer of an edited chunk has spare instances past the cubes
+    if (buffer && buffer_size > 0)
+        command_buffer.Draw(*buffer, buffer_size);
 }
 
-const Vulkan::IBuffer& Scene::Chunk::GetData() const
+void Chunk::DrawWater(const Vulkan::ICommandBuffer& command_buffer) const
 {
-    return *buffer;
+    if (water_buffer)
+        command_buffer.Draw(*water_buffer);
 }
 
 const std::pair<Point3D, Point3D>& Chunk::GetBBox() const
@@ -195,7 +182,19 @@ const std::pair<Point3D, Point3D>& Chunk::GetBBox() const
 
 utils::vec2i WorldToChunk(const utils::vec2i& pos)
 {
-    return { pos.x / g_chunk_size, pos.y / g_chunk_size };
+    return { utils::FloorDiv(pos.x, g_chunk_size), utils::FloorDiv(pos.y, g_chunk_size) };
+}
+
+Vulkan::BBox ToBBox(const std::pair<Point3D, Point3D>& bbox)
+{
+    return {
+        static_cast<float>(bbox.first.x),
+        static_cast<float>(bbox.first.y),
+        static_cast<float>(bbox.first.z),
+        static_cast<float>(bbox.second.x),
+        static_cast<float>(bbox.second.y),
+        static_cast<float>(bbox.second.z),
+    };
 }
 
 }
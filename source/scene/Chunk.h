@@ -4,6 +4,8 @@
 #include <map>
 #include <array>
 #include <mutex>
+#include <optional>
+#include <memory>
 
 #include "ChunkUtils.h"
 
@@ -11,6 +13,10 @@ namespace Vulkan
 {
 
 struct IFactory;
+struct IBuffer;
+struct ICommandBuffer;
+struct IStagingBuffer;
+struct BBox;
 
 }
 
@@ -19,10 +25,13 @@ struct INoise;
 namespace Scene
 {
 
+enum class TextureType : uint32_t;
+
 namespace utils
 {
 
 struct DefferedExecutor;
+struct DefferedTask;
 
 }
 
@@ -31,37 +40,101 @@ struct Point3D
     int32_t x = 0;
     int32_t y = 0;
     int32_t z = 0;
+
+    constexpr friend inline const bool operator<(const Point3D& p1, const Point3D& p2)
+    {
+        return std::tie(p1.x, p1.y, p1.z) < std::tie(p2.x, p2.y, p2.z);
+    }
+
+    constexpr friend inline const bool operator==(const Point3D& p1, const Point3D& p2)
+    {
+        return std::tie(p1.x, p1.y, p1.z) == std::tie(p2.x, p2.y, p2.z);
+    }
 };
 
+// std::nullopt marks a removed block
+using BlockEdits = std::map<Point3D, std::optional<TextureType>>;
+
+struct Structure;
+class StructureCache;
+struct CubeInstance;
+
+// Noise samples of a chunk, kept so that edits can be remeshed without regenerating
+struct ChunkTerrain
+{
+    std::vector<int32_t>   heights; // (chunk size + 2)^2, one column of padding on every side
+    std::vector<Structure> structures;
+};
+
+using ChunkTerrainPtr = std::shared_ptr<const ChunkTerrain>;
+
+constexpr int32_t g_chunk_size = 32;
+constexpr uint32_t g_grass_bottom = 57;
+constexpr uint32_t g_grass_top = 78;
+
 utils::vec2i WorldToChunk(const utils::vec2i& pos);
+Vulkan::BBox ToBBox(const std::pair<Point3D, Point3D>& bbox);
 
 struct Chunk
 {
-    Chunk(const utils::vec2i& base, Vulkan::IFactory& factory, INoise& noiser, utils::DefferedExecutor& pool);
+    // Occluder cells per side, every cell covers g_chunk_size / occluder_cells columns
+    static constexpr int32_t occluder_cells = 4;
+    // Spare instances of the terrain buffer of an edited chunk, so an edit adding cubes can still patch it
+    static constexpr uint32_t edit_spare_cubes = 256;
+
+    // lod > 0 meshes cells of 2^lod x 2^lod columns, edits and structures are only meshed at lod 0
+    Chunk(const utils::vec2i& base, uint32_t lod, Vulkan::IFactory& factory, INoise& noiser, StructureCache& structures, utils::DefferedExecutor& pool, const BlockEdits& edits);
+    Chunk(const utils::vec2i& base, uint32_t lod, ChunkTerrainPtr terrain, Vulkan::IFactory& factory, utils::DefferedExecutor& pool, const BlockEdits& edits);
     ~Chunk();
 
-    const Vulkan::IBuffer& GetData() const;
+    // Record nothing when the chunk has no instances of that kind
+    void Draw(const Vulkan::ICommandBuffer& command_buffer) const;
+    void DrawWater(const Vulkan::ICommandBuffer& command_buffer) const;
 
-    uint32_t GetWaterOffset() const { return water_offset; }
     uint32_t GetGpuSize() const { return buffer_size; }
-    bool HasWater() const { return has_water; }
+    uint32_t GetWaterSize() const { return water_size; }
+    // Edits can remove every block of a chunk, it then has no terrain buffer at all
+    bool HasCubes() const { return buffer_size > 0; }
+    bool HasWater() const { return water_size > 0; }
 
     const std::pair<Point3D, Point3D>& GetBBox() const;
+    const ChunkTerrainPtr& GetTerrain() const { return terrain; }
+    uint32_t GetLod() const { return lod; }
+    // Top of the solid ground under every occluder cell, x major, zero when there is no occluder
+    const std::array<int32_t, occluder_cells * occluder_cells>& GetOccluderHeights() const { return occluder_heights; }
 
-    bool Ready() const { return !!buffer; }
+    bool Ready() const { return committed; }
+
+    // Render thread, before the commit task ran. Takes over the terrain buffer of the chunk it replaces
+    // and uploads only the cubes that differ from it. False when either chunk has no kept cubes, the
+    // buffer is too small or the chunk is already committed, it is then committed as usual.
+    bool Patch(Chunk& previous);
 
 private:
     utils::vec2i                base_point{};
+    uint32_t                    lod = 0u;
     std::pair<Point3D, Point3D> bbox;
+    ChunkTerrainPtr             terrain;
+
+    std::array<int32_t, occluder_cells * occluder_cells> occluder_heights{};
 
     std::unique_ptr<Vulkan::IBuffer> buffer;
-    uint32_t water_offset = 0;
+    std::unique_ptr<Vulkan::IBuffer> water_buffer;
+    // Written by the mesher in place, committed into the buffers above on the render thread
+    std::unique_ptr<Vulkan::IStagingBuffer> staging;
+    std::unique_ptr<Vulkan::IStagingBuffer> water_staging;
     uint32_t buffer_size = 0;
-    bool has_water = false;
+    uint32_t buffer_capacity = 0;
+    uint32_t water_size = 0;
+    bool     committed = false;
+
+    // Lod 0 chunks with edits keep their cubes, the next edit of the chunk is likely and patches them
+    std::vector<CubeInstance> cubes;
+    bool                      keeps_cubes = false;
 
-    utils::DefferedExecutor& task_queue;
-    uint64_t                 create_id = 0u;
-    uint32_t                 frame_buffer_count = 1u;
+    Vulkan::IFactory&                    factory;
+    utils::DefferedExecutor&             task_queue;
+    std::shared_ptr<utils::DefferedTask> create_task;
 };
 
 using ChunkPtr = std::unique_ptr<Chunk>;
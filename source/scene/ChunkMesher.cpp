@@ -0,0 +1,459 @@
+#include "ChunkMesher.h"
+#include "Structures.h"
+#include "IResourceLoader.h"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+namespace Scene
+{
+
+// Counts instances while out is empty, writes them otherwise
+class InstanceSink
+{
+    std::span<CubeInstance> out;
+    uint32_t                count = 0u;
+
+public:
+    explicit InstanceSink(std::span<CubeInstance> out)
+        : out(out)
+    {
+    }
+
+    // Counts past the end of the output without writing, the caller compares the count
+    void Add(const CubeInstance& cube)
+    {
+        if (count < out.size())
+            out[count] = cube;
+        ++count;
+    }
+
+    uint32_t Count() const
+    {
+        return count;
+    }
+};
+
+struct MeshScratch
+{
+    std::vector<bool>    edited_columns;
+    std::vector<bool>    water;
+    std::vector<int32_t> heights;
+};
+
+static thread_local MeshScratch scratch;
+
+CubeInstance CreateFace(int32_t x, int32_t y, int32_t z, CubeFace face, TextureType type)
+{
+    CubeInstance cube = {};
+    cube.pos[0] = static_cast<float>(x);
+    cube.pos[1] = static_cast<float>(y);
+    cube.pos[2] = static_cast<float>(z);
+    cube.face = static_cast<uint32_t>(face);
+    cube.texture = static_cast<uint32_t>(type);
+    return cube;
+}
+
+CubeInstance CreateFace(int32_t x, int32_t y, int32_t z, CubeFace face)
+{
+    if (y > 84)
+        return CreateFace(x,y, z, face, TextureType::Snow);
+    else if (y > g_grass_top)
+        return CreateFace(x, y, z, face, TextureType::Stone);
+    else if (y > g_grass_bottom)
+        return CreateFace(x, y, z, face, face == CubeFace::top ? TextureType::GrassBlockTop :TextureType::GrassBlockSide);
+
+    return CreateFace(x, y, z, face, TextureType::Sand);
+}
+
+CubeInstance Scale(CubeInstance cube, int32_t x, int32_t y, int32_t z)
+{
+    cube.face |= static_cast<uint32_t>(x - 1) << 8 | static_cast<uint32_t>(y - 1) << 16 | static_cast<uint32_t>(z - 1) << 24;
+    return cube;
+}
+
+// Edited blocks replace the tree, a placed block is meshed with its column
+void AddTree(int32_t x, int32_t y, int32_t z, const std::pair<Point3D, Point3D>& bounds, const BlockEdits& edits, InstanceSink& cubes)
+{
+    auto add = [&](int32_t x, int32_t y, int32_t z, CubeFace face, TextureType type) {
+        if (x < bounds.first.x || x >= bounds.second.x || z < bounds.first.z || z >= bounds.second.z)
+            return;
+        if (edits.contains({ x, y, z }))
+            return;
+        cubes.Add(CreateFace(x, y, z, face, type));
+    };
+
+    constexpr int32_t height = 5;
+    constexpr int32_t rad = 2;
+    for (int i = 0; i < height; ++i)
+    {
+        add(x, y + i, z, CubeFace::front, TextureType::OakLog);
+        add(x, y + i, z, CubeFace::back, TextureType::OakLog);
+        add(x, y + i, z, CubeFace::left, TextureType::OakLog);
+        add(x, y + i, z, CubeFace::right, TextureType::OakLog);
+    }
+
+    for (int i = -rad; i <= rad; ++i)
+    {
+        for (int j = -rad; j <= rad; ++j)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                if (k == 2 && (std::abs(i) > 1 || std::abs(j) > 1))
+                    continue;
+                add(x + i, y + 3 + k, z + j, CubeFace::front, TextureType::LeavesOakOpaque);
+                add(x + i, y + 3 + k, z + j, CubeFace::back,  TextureType::LeavesOakOpaque);
+                add(x + i, y + 3 + k, z + j, CubeFace::left,  TextureType::LeavesOakOpaque);
+                add(x + i, y + 3 + k, z + j, CubeFace::right, TextureType::LeavesOakOpaque);
+            }
+
+            int add_top = !(std::abs(i) > 1 || std::abs(j) > 1);
+            add(x + i, y + 3, z + j, CubeFace::bottom, TextureType::LeavesOakOpaque);
+            add(x + i, y + 4 + add_top, z + j, CubeFace::top, TextureType::LeavesOakOpaque);
+        }
+    }
+
+    add(x, y + height - 1, z, CubeFace::top, TextureType::OakLogTop);
+}
+
+class ColumnSampler
+{
+    const ChunkTerrain& terrain;
+    const BlockEdits&   edits;
+    utils::vec2i        origin{};
+
+public:
+    ColumnSampler(const utils::vec2i& base, const ChunkTerrain& terrain, const BlockEdits& edits)
+        : terrain(terrain)
+        , edits(edits)
+        , origin(base.x * g_chunk_size, base.y * g_chunk_size)
+    {
+    }
+
+    int32_t GetHeight(int32_t x, int32_t z) const
+    {
+        return terrain.heights[(x - origin.x + 1) * (g_chunk_size + 2) + z - origin.y + 1];
+    }
+
+    // Nothing below y = 0, digging down to it leaves a hole through the world
+    std::optional<TextureType> GetBlock(int32_t x, int32_t y, int32_t z, CubeFace face) const
+    {
+        if (y < 0)
+            return std::nullopt;
+
+        auto edit = edits.find({ x, y, z });
+        if (edit != edits.end())
+            return edit->second;
+
+        if (y > GetHeight(x, z))
+            return std::nullopt;
+        return static_cast<TextureType>(CreateFace(x, y, z, face).texture);
+    }
+
+    bool IsSolid(int32_t x, int32_t y, int32_t z) const
+    {
+        return GetBlock(x, y, z, CubeFace::top).has_value();
+    }
+};
+
+void GetEditedColumns(const utils::vec2i& base, const BlockEdits& edits, std::vector<bool>& edited)
+{
+    edited.assign(g_chunk_size * g_chunk_size, false);
+    for (const auto& [pos, block] : edits)
+    {
+        auto x_offset = pos.x - base.x * g_chunk_size;
+        auto z_offset = pos.z - base.y * g_chunk_size;
+        for (const auto& [dx, dz] : { std::pair{ 0, 0 }, { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } })
+        {
+            auto x = x_offset + dx;
+            auto z = z_offset + dz;
+            if (x >= 0 && x < g_chunk_size && z >= 0 && z < g_chunk_size)
+                edited[x * g_chunk_size + z] = true;
+        }
+    }
+}
+
+void AddEditedColumn(int32_t x, int32_t z, const ColumnSampler& sampler, const BlockEdits& edits, InstanceSink& cubes, std::pair<Point3D, Point3D>& bbox)
+{
+    static constexpr std::array<std::tuple<int32_t, int32_t, int32_t, CubeFace>, 6> neighbours = { {
+        {  0,  0,  1, CubeFace::front  },
+        {  0,  0, -1, CubeFace::back   },
+        {  1,  0,  0, CubeFace::right  },
+        { -1,  0,  0, CubeFace::left   },
+        {  0,  1,  0, CubeFace::top    },
+        {  0, -1,  0, CubeFace::bottom },
+    } };
+
+    int32_t top = sampler.GetHeight(x, z);
+    int32_t bottom = top;
+    for (const auto& [dx, dy, dz, face] : neighbours)
+        bottom = std::min(bottom, sampler.GetHeight(x + dx, z + dz));
+
+    for (auto edit = edits.lower_bound({ x - 1, std::numeric_limits<int32_t>::min(), z - 1 }); edit != edits.end() && edit->first.x <= x + 1; ++edit)
+    {
+        const auto& pos = edit->first;
+        if (std::abs(pos.x - x) + std::abs(pos.z - z) > 1)
+            continue;
+
+        bottom = std::min(bottom, pos.y - 1);
+        if (pos.x == x && pos.z == z)
+            top = std::max(top, pos.y);
+    }
+
+    for (int32_t y = bottom; y <= top; ++y)
+    {
+        for (const auto& [dx, dy, dz, face] : neighbours)
+        {
+            auto block = sampler.GetBlock(x, y, z, face);
+            if (!block)
+                break;
+
+            if (!sampler.IsSolid(x + dx, y + dy, z + dz))
+                cubes.Add(CreateFace(x, y, z, face, *block));
+        }
+    }
+
+    bbox.first.y = std::min(bbox.first.y, bottom);
+    bbox.second.y = std::max(bbox.second.y, std::max(top + 1, static_cast<int32_t>(g_grass_bottom)));
+}
+
+// Meshes the heightfield with one cube column per cell: the cell takes the max height of its
+// columns and the most common top texture. Cells outside the chunk use the lowest adjacent
+// column, so the walls on the border reach down to whatever the neighbour chunk shows.
+void AddDownsampledTerrain(const utils::vec2i& base, uint32_t lod, const ColumnSampler& sampler, InstanceSink& cubes, std::vector<bool>& water, std::pair<Point3D, Point3D>& bbox)
+{
+    const int32_t cell = 1 << lod;
+    const int32_t cells = g_chunk_size / cell;
+    const int32_t padded_cells = cells + 2;
+    const utils::vec2i origin(base.x * g_chunk_size, base.y * g_chunk_size);
+
+    auto& heights = scratch.heights;
+    heights.assign(padded_cells * padded_cells, 0);
+    auto height = [&](int32_t cx, int32_t cz) -> int32_t& {
+        return heights[(cx + 1) * padded_cells + cz + 1];
+    };
+
+    auto border_height = [&](int32_t x, int32_t z, int32_t dx, int32_t dz) {
+        int32_t res = std::numeric_limits<int32_t>::max();
+        for (int32_t i = 0; i < cell; ++i)
+            res = std::min(res, sampler.GetHeight(x + dx * i, z + dz * i));
+        return res;
+    };
+
+    for (int32_t c = 0; c < cells; ++c)
+    {
+        height(-1, c) = border_height(origin.x - 1, origin.y + c * cell, 0, 1);
+        height(cells, c) = border_height(origin.x + g_chunk_size, origin.y + c * cell, 0, 1);
+        height(c, -1) = border_height(origin.x + c * cell, origin.y - 1, 1, 0);
+        height(c, cells) = border_height(origin.x + c * cell, origin.y + g_chunk_size, 1, 0);
+    }
+
+    std::array<uint32_t, static_cast<size_t>(TextureType::Count)> votes{};
+    for (int32_t cx = 0; cx < cells; ++cx)
+    {
+        for (int32_t cz = 0; cz < cells; ++cz)
+        {
+            auto x = origin.x + cx * cell;
+            auto z = origin.y + cz * cell;
+
+            votes.fill(0u);
+            int32_t max_height = std::numeric_limits<int32_t>::min();
+            for (int32_t i = 0; i < cell; ++i)
+            {
+                for (int32_t j = 0; j < cell; ++j)
+                {
+                    int32_t y = sampler.GetHeight(x + i, z + j);
+                    max_height = std::max(max_height, y);
+                    ++votes[CreateFace(x + i, y, z + j, CubeFace::top).texture];
+                }
+            }
+            height(cx, cz) = max_height;
+
+            auto dominant = static_cast<TextureType>(std::max_element(votes.begin(), votes.end()) - votes.begin());
+            cubes.Add(Scale(CreateFace(x, max_height + 1 - cell, z, CubeFace::top, dominant), cell, cell, cell));
+
+            water[cx * cells + cz] = max_height < static_cast<int32_t>(g_grass_bottom);
+        }
+    }
+
+    for (int32_t cx = 0; cx < cells; ++cx)
+    {
+        for (int32_t cz = 0; cz < cells; ++cz)
+        {
+            auto x = origin.x + cx * cell;
+            auto z = origin.y + cz * cell;
+            int32_t top = height(cx, cz);
+
+            bbox.second.y = std::max(bbox.second.y, std::max(top + 1, static_cast<int32_t>(g_grass_bottom)));
+
+            int32_t y = top + 1 - cell;
+            while (y + cell > 0)
+            {
+                auto before = cubes.Count();
+                auto add_side = [&](int32_t neighbour, CubeFace face) {
+                    if (neighbour < y + cell - 1)
+                        cubes.Add(Scale(CreateFace(x, y, z, face, static_cast<TextureType>(CreateFace(x, y + cell - 1, z, face).texture)), cell, cell, cell));
+                };
+                add_side(height(cx, cz + 1), CubeFace::front);
+                add_side(height(cx, cz - 1), CubeFace::back);
+                add_side(height(cx + 1, cz), CubeFace::right);
+                add_side(height(cx - 1, cz), CubeFace::left);
+
+                if (before == cubes.Count())
+                    break;
+
+                y -= cell;
+            }
+            bbox.first.y = std::min(bbox.first.y, y);
+        }
+    }
+}
+
+// Greedily covers the underwater cells with as few rectangles as possible
+void MergeWater(const utils::vec2i& base, int32_t cell, std::vector<bool>& water, InstanceSink& res)
+{
+    const int32_t cells = g_chunk_size / cell;
+    auto is_water = [&](int32_t cx, int32_t cz) {
+        return water[cx * cells + cz];
+    };
+
+    for (int32_t cx = 0; cx < cells; ++cx)
+    {
+        for (int32_t cz = 0; cz < cells; ++cz)
+        {
+            if (!is_water(cx, cz))
+                continue;
+
+            int32_t depth = 1;
+            while (cz + depth < cells && is_water(cx, cz + depth))
+                ++depth;
+
+            int32_t width = 1;
+            while (cx + width < cells && std::all_of(water.begin() + (cx + width) * cells + cz, water.begin() + (cx + width) * cells + cz + depth, [](bool w) { return w; }))
+                ++width;
+
+            for (int32_t i = 0; i < width; ++i)
+                std::fill_n(water.begin() + (cx + i) * cells + cz, depth, false);
+
+            auto x = base.x * g_chunk_size + cx * cell;
+            auto z = base.y * g_chunk_size + cz * cell;
+            res.Add(Scale(CreateFace(x, g_grass_bottom, z, CubeFace::top, TextureType::WaterOverlay), width * cell, 1, depth * cell));
+        }
+    }
+}
+
+ChunkMesher::ChunkMesher(const utils::vec2i& base, uint32_t lod, const ChunkTerrain& terrain, const BlockEdits& edits)
+    : base(base)
+    , lod(lod)
+    , terrain(terrain)
+    , edits(edits)
+{
+    mesh_size = Mesh({}, {}, bbox);
+}
+
+void ChunkMesher::Write(std::span<CubeInstance> cubes, std::span<CubeInstance> water) const
+{
+    if (cubes.size() != mesh_size.cubes || water.size() != mesh_size.water)
+        throw std::invalid_argument("Output does not match the mesh size");
+
+    std::pair<Point3D, Point3D> unused;
+    auto written = Mesh(cubes, water, unused);
+    // Both passes must emit the same faces, otherwise part of the output is left uninitialized
+    if (written.cubes != mesh_size.cubes || written.water != mesh_size.water)
+        throw std::logic_error("Mesh write pass does not match the counting pass");
+}
+
+MeshSize ChunkMesher::Mesh(std::span<CubeInstance> cubes_out, std::span<CubeInstance> water_out, std::pair<Point3D, Point3D>& bbox) const
+{
+    auto size = g_chunk_size;
+    bbox.first.x = base.x * size;
+    bbox.first.z = base.y * size;
+    bbox.first.y = std::numeric_limits<decltype(bbox.first.y)>::max();
+    bbox.second.x = base.x * size + size;
+    bbox.second.z = base.y * size + size;
+    bbox.second.y = 0;
+
+    ColumnSampler sampler(base, terrain, edits);
+    auto& edited_columns = scratch.edited_columns;
+    GetEditedColumns(base, edits, edited_columns);
+
+    const int32_t cell = 1 << lod;
+    InstanceSink cubes(cubes_out);
+    auto& water = scratch.water;
+    water.assign((size / cell) * (size / cell), false);
+    if (lod > 0)
+    {
+        AddDownsampledTerrain(base, lod, sampler, cubes, water, bbox);
+    }
+    else
+    {
+        for (int32_t x_offset = 0; x_offset < size; ++x_offset)
+        {
+            for (int32_t z_offset = 0; z_offset < size; ++z_offset)
+            {
+                auto x = base.x * size + x_offset;
+                auto z = base.y * size + z_offset;
+                int32_t y = sampler.GetHeight(x, z);
+
+                water[x_offset * size + z_offset] = y < g_grass_bottom;
+
+                if (edited_columns[x_offset * size + z_offset])
+                {
+                    AddEditedColumn(x, z, sampler, edits, cubes, bbox);
+                    continue;
+                }
+
+                cubes.Add(CreateFace(x, y, z, CubeFace::top));
+
+                bbox.second.y = std::max(bbox.second.y, std::max(y + 1, static_cast<int32_t>(g_grass_bottom)));
+                while (y >= 0)
+                {
+                    auto before = cubes.Count();
+                    if (sampler.GetHeight(x, z + 1) < y)
+                    {
+                        cubes.Add(CreateFace(x, y, z, CubeFace::front));
+                    }
+                    if (sampler.GetHeight(x, z - 1) < y)
+                    {
+                        cubes.Add(CreateFace(x, y, z, CubeFace::back));
+                    }
+                    if (sampler.GetHeight(x + 1, z) < y)
+                    {
+                        cubes.Add(CreateFace(x, y, z, CubeFace::right));
+                    }
+                    if (sampler.GetHeight(x - 1, z) < y)
+                    {
+                        cubes.Add(CreateFace(x, y, z, CubeFace::left));
+                    }
+
+                    if (before == cubes.Count())
+                        break;
+
+                    --y;
+                }
+                bbox.first.y = std::min(bbox.first.y, y);
+            }
+        }
+    }
+
+    for (const auto& structure : terrain.structures)
+    {
+        if (lod > 0)
+            break;
+
+        switch (structure.type)
+        {
+        case StructureType::Tree:
+            AddTree(structure.origin.x, structure.origin.y, structure.origin.z, bbox, edits, cubes);
+            break;
+        }
+        bbox.second.y = std::max(bbox.second.y, structure.bbox.second.y);
+    }
+
+    InstanceSink water_quads(water_out);
+    MergeWater(base, cell, water, water_quads);
+    return { cubes.Count(), water_quads.Count() };
+}
+
+}
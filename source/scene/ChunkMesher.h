@@ -0,0 +1,62 @@
+#pragma once
+
+#include <span>
+
+#include "Chunk.h"
+
+namespace Scene
+{
+
+enum class CubeFace : uint32_t
+{
+    front = 0,
+    back,
+    left,
+    right,
+    top,
+    bottom,
+    count,
+};
+
+// block.vert reads it from the storage buffer as five 32 bit words
+struct CubeInstance
+{
+    float    pos[3];
+    uint32_t texture;
+    uint32_t face; // CubeFace in the low byte, size - 1 along x, y, z in the upper bytes
+};
+static_assert(sizeof(CubeInstance) == 5 * sizeof(uint32_t), "Packed as block.vert expects");
+
+struct MeshSize
+{
+    uint32_t cubes = 0u;
+    uint32_t water = 0u;
+};
+
+// Builds the instances of a chunk from its terrain, independent of the renderer.
+// The constructor runs a counting pass so the caller can allocate the output once,
+// Write runs the second pass into it. Scratch memory is kept per thread.
+class ChunkMesher
+{
+public:
+    ChunkMesher(const utils::vec2i& base, uint32_t lod, const ChunkTerrain& terrain, const BlockEdits& edits);
+
+    const MeshSize& GetSize() const { return mesh_size; }
+    const std::pair<Point3D, Point3D>& GetBBox() const { return bbox; }
+
+    // Spans must hold exactly GetSize() instances
+    void Write(std::span<CubeInstance> cubes, std::span<CubeInstance> water) const;
+
+private:
+    MeshSize Mesh(std::span<CubeInstance> cubes, std::span<CubeInstance> water, std::pair<Point3D, Point3D>& bbox) const;
+
+    utils::vec2i        base{};
+    uint32_t            lod = 0u;
+    const ChunkTerrain& terrain;
+    const BlockEdits&   edits;
+
+    MeshSize                    mesh_size;
+    std::pair<Point3D, Point3D> bbox;
+};
+
+}
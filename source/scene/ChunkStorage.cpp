@@ -5,8 +5,13 @@
 #include <Noise.h>
 
 #include "Chunk.h"
+#include "FrameStats.h"
+#include "HorizonCuller.h"
+#include "Structures.h"
 #include "ThreadUtils.hpp"
 
+#include <set>
+
 namespace Scene
 {
 
@@ -19,6 +24,14 @@ struct ChunkWrapper
     ChunkPtr     chunk;
 };
 
+// Union of the chunk boxes of a world aligned block of super_chunk_size^2 chunks
+struct SuperChunk
+{
+    Vulkan::BBox bbox;
+    bool         empty = true;
+    bool         dirty = true;
+};
+
 class ChunkStorage
     : public IChunkStorage
 {
@@ -31,17 +44,43 @@ class ChunkStorage
     static constexpr int32_t render_distance = 16;
     static constexpr int32_t squere_len = render_distance * 2 + 1;
 
+    StructureCache structures{ *noiser, render_distance };
+
     using Chunks = std::vector<std::vector<ChunkPtr>>;
     using FutureChunks = std::vector<std::future<ChunkWrapper>>;
     Chunks chunks;
     FutureChunks future_chunks;
+    FutureChunks abandoned_chunks; // requested for a previous camera chunk, still running
 
     utils::vec2i current_chunk = g_invalid_pos;
 
+    std::map<utils::vec2i, BlockEdits> edits;
+    std::mutex                         edits_mutex;
+
+    FutureChunks              remeshed_futures;
+    std::vector<ChunkWrapper> remeshed_chunks;
+    std::set<utils::vec2i>    edited_while_loading;
+    uint32_t                  remesh_key = 0u;
+
+    static constexpr int32_t super_chunk_size = 4;
+    static constexpr int32_t super_squere_len = (squere_len + super_chunk_size - 1) / super_chunk_size + 1;
+
+    std::vector<SuperChunk>   super_chunks{ super_squere_len * super_squere_len };
+    std::vector<utils::vec2i> intersecting_positions;
+    std::vector<Vulkan::BBox> intersecting_boxes;
+    std::vector<uint64_t>     intersecting_visibility;
+
+    HorizonCuller             horizon;
+    std::vector<bool>         in_frustum = std::vector<bool>(squere_len * squere_len);
+    std::vector<const Chunk*> ring_chunks;
+
     utils::PriorityExecutor<ChunkWrapper> cpu_creation_pool;
+    utils::PriorityExecutor<ChunkWrapper> remesh_pool{ 1u };
 
     uint64_t frame_number = 0;
 
+    StorageStats stats;
+
     ChunkPtr& GetChunk(const utils::vec2i& mid, const utils::vec2i& pos)
     {
         return chunks[render_distance + pos.x - mid.x][render_distance + pos.y - mid.y];
@@ -52,6 +91,147 @@ class ChunkStorage
         return chunks[render_distance + pos.x - mid.x][render_distance + pos.y - mid.y];
     }
 
+    std::vector<bool>::reference InFrustum(const utils::vec2i& pos)
+    {
+        return in_frustum[(render_distance + pos.x - current_chunk.x) * squere_len + render_distance + pos.y - current_chunk.y];
+    }
+
+    static bool InRange(const utils::vec2i& mid, const utils::vec2i& pos)
+    {
+        return std::abs(pos.x - mid.x) <= render_distance && std::abs(pos.y - mid.y) <= render_distance;
+    }
+
+    static utils::vec2i ToSuperChunk(const utils::vec2i& pos)
+    {
+        return { utils::FloorDiv(pos.x, super_chunk_size), utils::FloorDiv(pos.y, super_chunk_size) };
+    }
+
+    utils::vec2i GetSuperOrigin() const
+    {
+        return ToSuperChunk(current_chunk - utils::vec2i(render_distance, render_distance));
+    }
+
+    SuperChunk* GetSuperChunk(const utils::vec2i& super_pos)
+    {
+        auto local = super_pos - GetSuperOrigin();
+        if (local.x < 0 || local.y < 0 || local.x >= super_squere_len || local.y >= super_squere_len)
+            return nullptr;
+        return &super_chunks[local.x * super_squere_len + local.y];
+    }
+
+    void SetChunk(const utils::vec2i& pos, ChunkPtr& chunk)
+    {
+        GetChunk(current_chunk, pos).swap(chunk);
+        if (auto super_chunk = GetSuperChunk(ToSuperChunk(pos)))
+            super_chunk->dirty = true;
+    }
+
+    template <typename Callback>
+    void ForEachInSuperChunk(const utils::vec2i& super_pos, Callback&& callback) const
+    {
+        for (int32_t x = 0; x < super_chunk_size; ++x)
+        {
+            for (int32_t y = 0; y < super_chunk_size; ++y)
+            {
+                utils::vec2i pos(super_pos.x * super_chunk_size + x, super_pos.y * super_chunk_size + y);
+                if (!InRange(current_chunk, pos))
+                    continue;
+
+                const auto& chunk = GetChunk(current_chunk, pos);
+                if (chunk)
+                    callback(pos, *chunk);
+            }
+        }
+    }
+
+    void UpdateSuperChunk(SuperChunk& super_chunk, const utils::vec2i& super_pos)
+    {
+        super_chunk.dirty = false;
+        super_chunk.empty = true;
+        ForEachInSuperChunk(super_pos, [&](const utils::vec2i&, const Chunk& chunk) {
+            auto bbox = ToBBox(chunk.GetBBox());
+            if (super_chunk.empty)
+            {
+                super_chunk.bbox = bbox;
+                super_chunk.empty = false;
+                return;
+            }
+            super_chunk.bbox.min_x = std::min(super_chunk.bbox.min_x, bbox.min_x);
+            super_chunk.bbox.min_y = std::min(super_chunk.bbox.min_y, bbox.min_y);
+            super_chunk.bbox.min_z = std::min(super_chunk.bbox.min_z, bbox.min_z);
+            super_chunk.bbox.max_x = std::max(super_chunk.bbox.max_x, bbox.max_x);
+            super_chunk.bbox.max_y = std::max(super_chunk.bbox.max_y, bbox.max_y);
+            super_chunk.bbox.max_z = std::max(super_chunk.bbox.max_z, bbox.max_z);
+        });
+    }
+
+    BlockEdits CollectEdits(const utils::vec2i& pos)
+    {
+        BlockEdits res;
+        Point3D min{ pos.x * g_chunk_size - 1, 0, pos.y * g_chunk_size - 1 };
+        Point3D max{ pos.x * g_chunk_size + g_chunk_size, 0, pos.y * g_chunk_size + g_chunk_size };
+
+        std::lock_guard lock(edits_mutex);
+        for (const auto& offset : { utils::vec2i(0, 0), utils::vec2i(1, 0), utils::vec2i(-1, 0), utils::vec2i(0, 1), utils::vec2i(0, -1) })
+        {
+            auto chunk_edits = edits.find(pos + offset);
+            if (chunk_edits == edits.end())
+                continue;
+
+            for (const auto& edit : chunk_edits->second)
+            {
+                const auto& p = edit.first;
+                if (p.x >= min.x && p.x <= max.x && p.z >= min.z && p.z <= max.z)
+                    res.insert(edit);
+            }
+        }
+        return res;
+    }
+
+    void Remesh(const utils::vec2i& pos)
+    {
+        if (!InRange(current_chunk, pos))
+            return;
+
+        const auto& chunk = GetChunk(current_chunk, pos);
+        if (!chunk)
+        {
+            edited_while_loading.insert(pos);
+            return;
+        }
+
+        remeshed_futures.emplace_back(remesh_pool.Add(remesh_key++,
+            std::bind([this](const utils::vec2i& pos, const ChunkTerrainPtr& terrain) -> ChunkWrapper {
+                PROFILE_ZONE("Chunk edit remesh");
+                // The lod when the task runs, a lod remesh may have replaced the chunk since the edit
+                auto lod = utils::GetLod(current_chunk, pos);
+                return { pos, pos, std::make_unique<Chunk>(pos, lod, terrain, factory, gpu_creation_pool, CollectEdits(pos)) };
+            },
+            pos,
+            chunk->GetTerrain()
+        )));
+    }
+
+    void EditBlock(const Point3D& pos, std::optional<TextureType> block)
+    {
+        auto chunk_pos = WorldToChunk({ pos.x, pos.z });
+        {
+            std::lock_guard lock(edits_mutex);
+            edits[chunk_pos][pos] = block;
+        }
+
+        auto local = utils::vec2i(pos.x, pos.z) - utils::vec2i(chunk_pos.x * g_chunk_size, chunk_pos.y * g_chunk_size);
+        Remesh(chunk_pos);
+        if (local.x == 0)
+            Remesh(chunk_pos - utils::vec2i(1, 0));
+        if (local.x == g_chunk_size - 1)
+            Remesh(chunk_pos + utils::vec2i(1, 0));
+        if (local.y == 0)
+            Remesh(chunk_pos - utils::vec2i(0, 1));
+        if (local.y == g_chunk_size - 1)
+            Remesh(chunk_pos + utils::vec2i(0, 1));
+    }
+
 public:
     utils::vec2i GetCamPos() const
     {
@@ -69,19 +249,15 @@ public:
             x.resize(squere_len);
 
         future_chunks.resize(squere_len * squere_len);
+        stats.chunks_in_range = squere_len * squere_len;
 
+        // Only schedules the chunks, the first frames run while the workers generate them
         DoCpuWork();
-        const auto& chunk = GetChunk(current_chunk, current_chunk);
-        while (!chunk)
-        {
-            UpdateChunks();
-            std::this_thread::sleep_for(std::chrono::microseconds(1u));
-        }
-        DoGpuWork();
     }
 
     void DoCpuWork()
     {
+        PROFILE_ZONE("ChunkStorage::DoCpuWork");
         auto cam_chunk = GetCamPos();
         if (cam_chunk == current_chunk)
             return UpdateChunks();
@@ -93,20 +269,50 @@ public:
             utils::ShiftPlane(translation, chunks);
         }
 
+        for (auto& future_chunk : future_chunks)
+        {
+            if (future_chunk.valid())
+                abandoned_chunks.emplace_back(std::move(future_chunk));
+        }
+
         current_chunk = cam_chunk;
+        for (auto& super_chunk : super_chunks)
+            super_chunk.dirty = true;
+
         utils::IterateFromMid(render_distance, current_chunk, [&](int index, const utils::vec2i& pos) {
             const auto& chunk = GetChunk(current_chunk, pos);
+            auto lod = utils::GetLod(current_chunk, pos);
+            if (chunk && chunk->GetLod() == lod)
+                return;
+
             if (chunk)
+            {
+                // Remesh the loaded terrain, the old lod stays on screen until the new one is swapped in
+                future_chunks[index] = cpu_creation_pool.Add(index,
+                    std::bind([this](const utils::vec2i& mid, const utils::vec2i& pos, uint32_t lod, const ChunkTerrainPtr& terrain) -> ChunkWrapper {
+                        if (mid != current_chunk)
+                            return { g_invalid_pos, g_invalid_pos, nullptr };
+                        PROFILE_ZONE("Chunk lod remesh");
+                        return { mid, pos, std::make_unique<Chunk>(pos, lod, terrain, factory, gpu_creation_pool, CollectEdits(pos)) };
+                    },
+                    current_chunk,
+                    pos,
+                    lod,
+                    chunk->GetTerrain()
+                ));
                 return;
+            }
 
             future_chunks[index] = cpu_creation_pool.Add(index,
-                std::bind([this](const utils::vec2i& mid, const utils::vec2i& pos) -> ChunkWrapper {
+                std::bind([this](const utils::vec2i& mid, const utils::vec2i& pos, uint32_t lod) -> ChunkWrapper {
                     if (mid != current_chunk)
                         return { g_invalid_pos, g_invalid_pos, nullptr };
-                    return { mid, pos, std::make_unique<Chunk>(pos, factory, *noiser, gpu_creation_pool) };
+                    PROFILE_ZONE("Chunk generation");
+                    return { mid, pos, std::make_unique<Chunk>(pos, lod, factory, *noiser, structures, gpu_creation_pool, CollectEdits(pos)) };
                 },
                 current_chunk,
-                pos
+                pos,
+                lod
             ));
         });
 
@@ -115,29 +321,134 @@ public:
 
     void UpdateChunks()
     {
+        stats.pending_chunks = 0;
         for (auto& future_chunk : future_chunks)
         {
-            bool ready = future_chunk.valid() && future_chunk.wait_for(std::chrono::milliseconds(0u)) == std::future_status::ready;
+            if (!future_chunk.valid())
+                continue;
+
+            bool ready = future_chunk.wait_for(std::chrono::milliseconds(0u)) == std::future_status::ready;
             if (!ready)
+            {
+                ++stats.pending_chunks;
                 continue;
+            }
 
             auto data = future_chunk.get();
-            if (!data.chunk || current_chunk != data.mid)
+            if (!data.chunk)
                 continue;
 
-            GetChunk(current_chunk, data.pos).swap(data.chunk);
+            ++stats.chunks_built;
+            if (current_chunk != data.mid)
+            {
+                ++stats.chunks_discarded;
+                continue;
+            }
+
+            auto& chunk = GetChunk(current_chunk, data.pos);
+            if (chunk)
+            {
+                remeshed_chunks.emplace_back(std::move(data));
+                continue;
+            }
+
+            SetChunk(data.pos, data.chunk);
+
+            if (edited_while_loading.erase(data.pos))
+                Remesh(data.pos);
         }
+
+        std::erase_if(abandoned_chunks, [this](auto& future_chunk) {
+            if (future_chunk.wait_for(std::chrono::milliseconds(0u)) != std::future_status::ready)
+                return false;
+
+            try
+            {
+                if (future_chunk.get().chunk)
+                {
+                    ++stats.chunks_built;
+                    ++stats.chunks_discarded;
+                }
+            }
+            catch (const std::future_error&)
+            {
+                // Replaced in the queue by a request for the new camera chunk before it started
+            }
+            return true;
+        });
+
+        std::erase_if(remeshed_futures, [this](auto& future_chunk) {
+            if (future_chunk.wait_for(std::chrono::milliseconds(0u)) != std::future_status::ready)
+                return false;
+
+            ++stats.chunks_built;
+            auto data = future_chunk.get();
+            PatchRemeshed(data);
+            remeshed_chunks.emplace_back(std::move(data));
+            return true;
+        });
+    }
+
+    // Before this frame's gpu tasks commit the remeshed chunk into a new buffer. Only when
+    // SwapRemeshed is sure to swap it in later this frame, the chunk on screen loses its buffer.
+    void PatchRemeshed(ChunkWrapper& data)
+    {
+        if (!InRange(current_chunk, data.pos) || data.chunk->GetLod() != utils::GetLod(current_chunk, data.pos))
+            return;
+
+        auto& chunk = GetChunk(current_chunk, data.pos);
+        if (chunk && chunk->Ready() && data.chunk->Patch(*chunk))
+            ++stats.chunks_patched;
+    }
+
+    void SwapRemeshed()
+    {
+        std::erase_if(remeshed_chunks, [this](ChunkWrapper& data) {
+            if (!InRange(current_chunk, data.pos))
+            {
+                ++stats.chunks_discarded;
+                return true;
+            }
+
+            // Meshed for an earlier camera chunk. Remeshed again rather than dropped, the chunk
+            // on screen may already have the wanted lod and be missing the edit of this remesh.
+            if (data.chunk->GetLod() != utils::GetLod(current_chunk, data.pos))
+            {
+                ++stats.chunks_discarded;
+                Remesh(data.pos);
+                return true;
+            }
+
+            if (!data.chunk->Ready())
+                return false;
+
+            SetChunk(data.pos, data.chunk);
+            return true;
+        });
     }
 
     void DoGpuWork()
     {
-        gpu_creation_pool.Execute(frame_number++);
+        PROFILE_ZONE("ChunkStorage::DoGpuWork");
+        stats.uploads = static_cast<uint32_t>(gpu_creation_pool.Execute(frame_number++));
+        SwapRemeshed();
     }
 
     void OnRender() override
     {
+        utils::Stopwatch stopwatch;
         DoCpuWork();
+        stats.update_time = stopwatch.Lap();
         DoGpuWork();
+        stats.drain_time = stopwatch.Lap();
+
+        stats.pending_remeshes = static_cast<uint32_t>(remeshed_futures.size() + remeshed_chunks.size());
+        stats.pending_gpu_tasks = static_cast<uint32_t>(gpu_creation_pool.Size());
+    }
+
+    const StorageStats& GetStats() const override
+    {
+        return stats;
     }
 
     void ForEach(const std::function<void(const Chunk&)>& callback) override
@@ -150,6 +461,91 @@ public:
             callback(*chunk);
         });
     }
+
+    void MarkInFrustum()
+    {
+        std::fill(in_frustum.begin(), in_frustum.end(), false);
+        intersecting_positions.clear();
+        intersecting_boxes.clear();
+
+        utils::IterateFromMid(super_squere_len, ToSuperChunk(current_chunk), [&](int, const utils::vec2i& super_pos) {
+            auto super_chunk = GetSuperChunk(super_pos);
+            if (!super_chunk)
+                return;
+
+            if (super_chunk->dirty)
+                UpdateSuperChunk(*super_chunk, super_pos);
+            if (super_chunk->empty)
+                return;
+
+            auto visibility = camera.ClassifyBox(super_chunk->bbox);
+            if (visibility == Vulkan::Visibility::Outside)
+                return;
+
+            ForEachInSuperChunk(super_pos, [&](const utils::vec2i& pos, const Chunk& chunk) {
+                if (!chunk.Ready())
+                    return;
+
+                if (visibility == Vulkan::Visibility::Inside)
+                {
+                    InFrustum(pos) = true;
+                    return;
+                }
+
+                intersecting_positions.emplace_back(pos);
+                intersecting_boxes.emplace_back(ToBBox(chunk.GetBBox()));
+            });
+        });
+
+        intersecting_visibility.resize((intersecting_boxes.size() + 63) / 64);
+        camera.CullBoxes(intersecting_boxes, intersecting_visibility);
+        for (size_t i = 0; i < intersecting_positions.size(); ++i)
+        {
+            if (intersecting_visibility[i / 64] & (1ull << (i % 64)))
+                InFrustum(intersecting_positions[i]) = true;
+        }
+    }
+
+    void ForEachVisible(const std::function<void(const Chunk&)>& callback) override
+    {
+        PROFILE_ZONE("ChunkStorage::ForEachVisible");
+        MarkInFrustum();
+
+        // Chunks of a ring are tested against the nearer rings only, then raise the horizon
+        int32_t ring = 0;
+        horizon.Begin(camera.GetViewPos());
+        ring_chunks.clear();
+        stats.chunks_loaded = 0;
+        utils::IterateFromMid(render_distance, current_chunk, [&](int, const utils::vec2i& pos) {
+            auto pos_ring = std::max(std::abs(pos.x - current_chunk.x), std::abs(pos.y - current_chunk.y));
+            if (pos_ring != ring)
+            {
+                for (auto chunk : ring_chunks)
+                    horizon.AddOccluder(chunk->GetBBox());
+                ring_chunks.clear();
+                ring = pos_ring;
+            }
+
+            const auto& chunk = GetChunk(current_chunk, pos);
+            if (!chunk || !chunk->Ready())
+                return;
+
+            ++stats.chunks_loaded;
+            ring_chunks.emplace_back(chunk.get());
+            if (InFrustum(pos) && horizon.IsVisible(chunk->GetBBox()))
+                callback(*chunk);
+        });
+    }
+
+    void SetBlock(const Point3D& pos, TextureType type) override
+    {
+        EditBlock(pos, type);
+    }
+
+    void RemoveBlock(const Point3D& pos) override
+    {
+        EditBlock(pos, std::nullopt);
+    }
 };
 
 std::unique_ptr<IChunkStorage> IChunkStorage::Create(Vulkan::ICamera& camera, Vulkan::IFactory& factory)
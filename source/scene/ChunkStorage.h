@@ -2,6 +2,7 @@
 
 #include <functional>
 #include <memory>
+#include <cstdint>
 
 namespace Vulkan
 {
@@ -16,12 +17,42 @@ namespace Scene
 {
 
 struct Chunk;
+struct Point3D;
+enum class TextureType : uint32_t;
+
+// Last OnRender and ForEachVisible calls, times in microseconds
+struct StorageStats
+{
+    uint64_t update_time = 0u;
+    uint64_t drain_time = 0u;
+
+    uint32_t chunks_loaded = 0u;
+    uint32_t chunks_in_range = 0u; // chunks_loaded once the whole render distance is loaded
+    uint32_t uploads = 0u; // gpu tasks run, chunk uploads
+    uint32_t pending_chunks = 0u;
+    uint32_t pending_remeshes = 0u;
+    uint32_t pending_gpu_tasks = 0u;
+
+    // Totals since creation, a chunk is discarded when the camera moved away before it was shown
+    uint64_t chunks_built = 0u;
+    uint64_t chunks_discarded = 0u;
+    uint64_t chunks_patched = 0u; // edit remeshes that uploaded only their changed cubes
+};
 
 struct IChunkStorage
 {
     virtual void OnRender() = 0;
+    virtual const StorageStats& GetStats() const = 0;
 
     virtual void ForEach(const std::function<void(const Chunk&)>& callback) = 0;
+    // Ready chunks in the camera frustum and above the terrain horizon, near to far.
+    // The frustum is tested per super chunk of 4x4 chunks first.
+    virtual void ForEachVisible(const std::function<void(const Chunk&)>& callback) = 0;
+
+    // Must be called from the thread that calls OnRender. Only the touched chunk
+    // and the neighbours sharing the edited border are remeshed, in background.
+    virtual void SetBlock(const Point3D& pos, TextureType type) = 0;
+    virtual void RemoveBlock(const Point3D& pos) = 0;
 
     virtual ~IChunkStorage() = default;
 
@@ -8,6 +8,11 @@ namespace Scene
 namespace utils
 {
 
+int32_t FloorDiv(int32_t value, int32_t divisor)
+{
+    return value / divisor - (value % divisor < 0 ? 1 : 0);
+}
+
 uint32_t GetRank(const vec2i& mid, const vec2i& pos)
 {
     if (mid == pos)
@@ -29,6 +34,16 @@ uint32_t GetRank(const vec2i& mid, const vec2i& pos)
     return static_cast<uint32_t>((d * 2 - 1)* (d * 2 - 1) + o);
 }
 
+uint32_t GetLod(const vec2i& mid, const vec2i& pos)
+{
+    int32_t d = std::max(std::abs(pos.x - mid.x), std::abs(pos.y - mid.y));
+    if (d < 6)
+        return 0;
+    if (d < 11)
+        return 1;
+    return 2;
+}
+
 void IterateFromMid(int distance, const utils::vec2i& mid, const std::function<void(int, const utils::vec2i&)>& callback)
 {
     int ind = 0;
@@ -50,8 +50,13 @@ struct vec2
 
 using vec2i = vec2<int32_t>;
 
+int32_t FloorDiv(int32_t value, int32_t divisor);
+
 uint32_t GetRank(const vec2i& mid, const vec2i& pos);
 
+// 0 for full resolution, n for cells of 2^n x 2^n columns
+uint32_t GetLod(const vec2i& mid, const vec2i& pos);
+
 void IterateFromMid(int distance, const utils::vec2i& mid, const std::function<void(int, const utils::vec2i&)>& callback);
 
 template <typename T>
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace Scene
+{
+namespace utils
+{
+
+// Microseconds between consecutive laps
+class Stopwatch
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    uint64_t Lap()
+    {
+        auto now = Clock::now();
+        auto res = std::chrono::duration_cast<std::chrono::microseconds>(now - last).count();
+        last = now;
+        return static_cast<uint64_t>(res);
+    }
+
+private:
+    Clock::time_point last = Clock::now();
+};
+
+// Percentiles of the last window_size samples, adding is O(1)
+template <size_t window_size>
+class RollingPercentiles
+{
+public:
+    void Add(uint64_t value)
+    {
+        samples[next++ % window_size] = value;
+    }
+
+    // percentiles are in [0, 100], sorted ascending, the result is written in the same order
+    template <size_t count>
+    std::array<uint64_t, count> Get(const std::array<double, count>& percentiles) const
+    {
+        std::array<uint64_t, count> res{};
+        auto size = std::min<size_t>(next, window_size);
+        if (size == 0)
+            return res;
+
+        sorted = samples;
+        auto begin = sorted.begin();
+        auto end = sorted.begin() + size;
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto rank = static_cast<size_t>(percentiles[i] / 100.0 * (size - 1) + 0.5);
+            auto nth = sorted.begin() + rank;
+            std::nth_element(begin, nth, end);
+            res[i] = *nth;
+            begin = nth;
+        }
+        return res;
+    }
+
+private:
+    std::array<uint64_t, window_size>         samples{};
+    mutable std::array<uint64_t, window_size> sorted{};
+    size_t                                    next = 0;
+};
+
+}
+}
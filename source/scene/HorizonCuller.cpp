@@ -0,0 +1,96 @@
+#include "HorizonCuller.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numbers>
+
+namespace Scene
+{
+
+constexpr float g_bucket_angle = 2.f * std::numbers::pi_v<float> / HorizonCuller::buckets;
+
+// Footprint angles may leave [-pi, pi] by less than half a turn
+static int32_t WrapBucket(int32_t bucket)
+{
+    return ((bucket % HorizonCuller::buckets) + HorizonCuller::buckets) % HorizonCuller::buckets;
+}
+
+void HorizonCuller::Begin(const Vulkan::Vector3f& eye_pos)
+{
+    eye = eye_pos;
+    horizon.fill(-std::numeric_limits<float>::infinity());
+}
+
+bool HorizonCuller::GetFootprint(const std::pair<Point3D, Point3D>& bbox, Footprint& res) const
+{
+    float min_x = bbox.first.x - eye.x;
+    float max_x = bbox.second.x - eye.x;
+    float min_z = bbox.first.z - eye.z;
+    float max_z = bbox.second.z - eye.z;
+    if (min_x <= 0.f && max_x >= 0.f && min_z <= 0.f && max_z >= 0.f)
+        return false;
+
+    float near_x = std::max({ min_x, -max_x, 0.f });
+    float near_z = std::max({ min_z, -max_z, 0.f });
+    float far_x = std::max(-min_x, max_x);
+    float far_z = std::max(-min_z, max_z);
+    res.min_distance = std::sqrt(near_x * near_x + near_z * near_z);
+    res.max_distance = std::sqrt(far_x * far_x + far_z * far_z);
+
+    // The eye is outside, so the box spans less than half a turn around the center direction
+    float mid_angle = std::atan2((min_z + max_z) * 0.5f, (min_x + max_x) * 0.5f);
+    res.min_angle = mid_angle;
+    res.max_angle = mid_angle;
+    for (const auto& [x, z] : { std::pair{ min_x, min_z }, { min_x, max_z }, { max_x, min_z }, { max_x, max_z } })
+    {
+        float diff = std::remainder(std::atan2(z, x) - mid_angle, 2.f * std::numbers::pi_v<float>);
+        res.min_angle = std::min(res.min_angle, mid_angle + diff);
+        res.max_angle = std::max(res.max_angle, mid_angle + diff);
+    }
+    return true;
+}
+
+bool HorizonCuller::IsVisible(const std::pair<Point3D, Point3D>& bbox) const
+{
+    Footprint footprint;
+    if (!GetFootprint(bbox, footprint) || footprint.min_distance <= 0.f)
+        return true;
+
+    // The steepest ray that can reach the top of the box
+    float height = bbox.second.y - eye.y;
+    float slope = height / (height > 0.f ? footprint.min_distance : footprint.max_distance);
+
+    auto first = static_cast<int32_t>(std::floor(footprint.min_angle / g_bucket_angle));
+    auto last = static_cast<int32_t>(std::floor(footprint.max_angle / g_bucket_angle));
+    for (auto bucket = first; bucket <= last; ++bucket)
+    {
+        if (slope >= horizon[WrapBucket(bucket)])
+            return true;
+    }
+    return false;
+}
+
+void HorizonCuller::AddOccluder(const std::pair<Point3D, Point3D>& bbox)
+{
+    Footprint footprint;
+    if (!GetFootprint(bbox, footprint))
+        return;
+
+    // The lowest ray that still hits the solid ground anywhere over the box
+    float height = bbox.first.y - eye.y;
+    float distance = height > 0.f ? footprint.max_distance : footprint.min_distance;
+    if (distance <= 0.f)
+        return;
+    float slope = height / distance;
+
+    auto first = static_cast<int32_t>(std::ceil(footprint.min_angle / g_bucket_angle));
+    auto last = static_cast<int32_t>(std::floor(footprint.max_angle / g_bucket_angle));
+    for (auto bucket = first; bucket < last; ++bucket)
+    {
+        auto& value = horizon[WrapBucket(bucket)];
+        value = std::max(value, slope);
+    }
+}
+
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <ICamera.h>
+
+#include <array>
+
+#include "Chunk.h"
+
+namespace Scene
+{
+
+// Max elevation of the terrain around the eye per azimuth bucket. Boxes must be tested
+// and added in rings of growing Chebyshev distance around the eye chunk, a ray that left
+// a ring never enters it again, so every occluder lies between the eye and the boxes
+// tested after it.
+class HorizonCuller
+{
+public:
+    static constexpr int32_t buckets = 512;
+
+    void Begin(const Vulkan::Vector3f& eye);
+
+    // The box top is above the horizon in at least one bucket it covers
+    bool IsVisible(const std::pair<Point3D, Point3D>& bbox) const;
+
+    // The ground under a chunk is solid up to the bottom of its box,
+    // only buckets fully covered by the box are raised
+    void AddOccluder(const std::pair<Point3D, Point3D>& bbox);
+
+private:
+    struct Footprint
+    {
+        float min_angle = 0.f;
+        float max_angle = 0.f;
+        float min_distance = 0.f;
+        float max_distance = 0.f;
+    };
+
+    // False when the eye stands over the box, nothing can be said about it then
+    bool GetFootprint(const std::pair<Point3D, Point3D>& bbox, Footprint& res) const;
+
+    Vulkan::Vector3f           eye{};
+    std::array<float, buckets> horizon{};
+};
+
+}
@@ -0,0 +1,165 @@
+#include "MipChain.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define MIP_CHAIN_SSE
+#endif
+
+namespace Scene
+{
+
+// Linear color premultiplied by alpha, smaller levels are filtered from the float level above
+// rather than from its bytes, so rounding does not build up down the chain
+struct Texel
+{
+    float r = 0.f;
+    float g = 0.f;
+    float b = 0.f;
+    float a = 0.f;
+};
+static_assert(sizeof(Texel) == 4 * sizeof(float), "Texel is loaded as one SSE register");
+
+static float ToLinear(float value)
+{
+    return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+}
+
+static float ToSrgb(float value)
+{
+    value = std::clamp(value, 0.f, 1.f);
+    return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.f / 2.4f) - 0.055f;
+}
+
+static uint8_t ToByte(float value)
+{
+    return static_cast<uint8_t>(std::clamp(value * 255.f + 0.5f, 0.f, 255.f));
+}
+
+static void Decode(const uint8_t* src, std::vector<Texel>& dst)
+{
+    for (auto& texel : dst)
+    {
+        texel = {};
+        if (src[3])
+        {
+            // Premultiplied in sRGB, the color is divided out before it is linearized
+            float alpha = src[3] / 255.f;
+            float scale = 1.f / src[3];
+            texel.r = ToLinear(std::min(src[0] * scale, 1.f)) * alpha;
+            texel.g = ToLinear(std::min(src[1] * scale, 1.f)) * alpha;
+            texel.b = ToLinear(std::min(src[2] * scale, 1.f)) * alpha;
+            texel.a = alpha;
+        }
+        src += 4;
+    }
+}
+
+static void Encode(const std::vector<Texel>& src, uint8_t* dst)
+{
+    for (const auto& texel : src)
+    {
+        auto alpha = ToByte(texel.a);
+        if (alpha)
+        {
+            // Premultiplied by the stored alpha, as the decoder divides by it
+            float stored_alpha = alpha / 255.f;
+            dst[0] = ToByte(ToSrgb(texel.r / texel.a) * stored_alpha);
+            dst[1] = ToByte(ToSrgb(texel.g / texel.a) * stored_alpha);
+            dst[2] = ToByte(ToSrgb(texel.b / texel.a) * stored_alpha);
+        }
+        else
+        {
+            dst[0] = dst[1] = dst[2] = 0u;
+        }
+        dst[3] = alpha;
+        dst += 4;
+    }
+}
+
+// 2x2 box, the last row and column repeat for odd sizes
+static void Downsample(const std::vector<Texel>& src, uint32_t src_width, uint32_t src_height, std::vector<Texel>& dst, uint32_t width, uint32_t height)
+{
+    dst.resize(static_cast<size_t>(width) * height);
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        const auto* row0 = &src[std::min(2u * y, src_height - 1u) * src_width];
+        const auto* row1 = &src[std::min(2u * y + 1u, src_height - 1u) * src_width];
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            auto x0 = std::min(2u * x, src_width - 1u);
+            auto x1 = std::min(2u * x + 1u, src_width - 1u);
+            auto& res = dst[y * width + x];
+#ifdef MIP_CHAIN_SSE
+            __m128 top = _mm_add_ps(_mm_loadu_ps(&row0[x0].r), _mm_loadu_ps(&row0[x1].r));
+            __m128 bottom = _mm_add_ps(_mm_loadu_ps(&row1[x0].r), _mm_loadu_ps(&row1[x1].r));
+            _mm_storeu_ps(&res.r, _mm_mul_ps(_mm_add_ps(top, bottom), _mm_set1_ps(0.25f)));
+#else
+            res.r = (row0[x0].r + row0[x1].r + row1[x0].r + row1[x1].r) * 0.25f;
+            res.g = (row0[x0].g + row0[x1].g + row1[x0].g + row1[x1].g) * 0.25f;
+            res.b = (row0[x0].b + row0[x1].b + row1[x0].b + row1[x1].b) * 0.25f;
+            res.a = (row0[x0].a + row0[x1].a + row1[x0].a + row1[x1].a) * 0.25f;
+#endif
+        }
+    }
+}
+
+uint32_t GetMipLevels(uint32_t width, uint32_t height)
+{
+    uint32_t res = 1u;
+    for (auto size = std::max(width, height); size > 1u; size >>= 1u)
+        ++res;
+    return res;
+}
+
+uint64_t GetMipChainSize(uint32_t width, uint32_t height, uint32_t depth)
+{
+    uint64_t res = 0u;
+    auto levels = GetMipLevels(width, height);
+    for (uint32_t level = 0; level < levels; ++level)
+        res += static_cast<uint64_t>(std::max(width >> level, 1u)) * std::max(height >> level, 1u) * depth * 4u;
+    return res;
+}
+
+std::vector<uint8_t> BuildMipChain(std::span<const uint8_t> base, uint32_t width, uint32_t height, uint32_t depth)
+{
+    auto layer_size = static_cast<size_t>(width) * height * 4u;
+    if (base.size() != layer_size * depth)
+        throw std::logic_error("Mip chain base does not match its size");
+
+    std::vector<uint8_t> res(GetMipChainSize(width, height, depth));
+    std::copy(base.begin(), base.end(), res.begin());
+
+    auto levels = GetMipLevels(width, height);
+    std::vector<Texel> level_texels(static_cast<size_t>(width) * height);
+    std::vector<Texel> next_texels;
+    for (uint32_t layer = 0; layer < depth; ++layer)
+    {
+        Decode(base.data() + layer * layer_size, level_texels);
+
+        auto level_width = width;
+        auto level_height = height;
+        auto level_offset = base.size();
+        for (uint32_t level = 1; level < levels; ++level)
+        {
+            auto next_width = std::max(level_width / 2u, 1u);
+            auto next_height = std::max(level_height / 2u, 1u);
+            Downsample(level_texels, level_width, level_height, next_texels, next_width, next_height);
+
+            auto next_layer_size = static_cast<size_t>(next_width) * next_height * 4u;
+            Encode(next_texels, res.data() + level_offset + layer * next_layer_size);
+
+            level_offset += next_layer_size * depth;
+            level_width = next_width;
+            level_height = next_height;
+            level_texels.swap(next_texels);
+        }
+        level_texels.resize(static_cast<size_t>(width) * height);
+    }
+    return res;
+}
+
+}
@@ -0,0 +1,265 @@
+#include "OcclusionCuller.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define OCCLUSION_CULLER_SSE
+#endif
+
+namespace Scene
+{
+
+// Points closer than this to the eye plane are not projected, faces and boxes touching them
+// are skipped as occluders and treated as visible as occludees
+constexpr float g_min_w = 0.1f;
+constexpr float g_far_depth = std::numeric_limits<float>::max();
+
+OcclusionCuller::OcclusionCuller()
+    : depth(width * height, g_far_depth)
+{
+    for (int32_t level_width = width, level_height = height; level_width > 1 || level_height > 1;)
+    {
+        level_width = (level_width + 1) / 2;
+        level_height = (level_height + 1) / 2;
+        levels.push_back({ level_width, level_height, std::vector<float>(level_width * level_height, g_far_depth) });
+    }
+}
+
+void OcclusionCuller::Begin(const std::array<float, 16>& view_projection, const Vulkan::Vector3f& eye_pos)
+{
+    matrix = view_projection;
+    eye = eye_pos;
+    std::fill(depth.begin(), depth.end(), g_far_depth);
+}
+
+bool OcclusionCuller::Project(float x, float y, float z, ScreenVertex& res) const
+{
+    const auto& m = matrix;
+    float w = m[3] * x + m[7] * y + m[11] * z + m[15];
+    if (w < g_min_w)
+        return false;
+
+    float cx = m[0] * x + m[4] * y + m[8] * z + m[12];
+    float cy = m[1] * x + m[5] * y + m[9] * z + m[13];
+    float cz = m[2] * x + m[6] * y + m[10] * z + m[14];
+    res.x = (cx / w * 0.5f + 0.5f) * width;
+    res.y = (cy / w * 0.5f + 0.5f) * height;
+    res.z = cz / w;
+    return true;
+}
+
+void OcclusionCuller::AddOccluder(const Vulkan::BBox& box, uint32_t faces)
+{
+    const auto& b = box;
+    if (faces & Faces::Top && eye.y > b.max_y)
+        RasterizeQuad({ { { b.min_x, b.max_y, b.min_z }, { b.max_x, b.max_y, b.min_z }, { b.max_x, b.max_y, b.max_z }, { b.min_x, b.max_y, b.max_z } } });
+    if (faces & Faces::NegativeX && eye.x < b.min_x)
+        RasterizeQuad({ { { b.min_x, b.min_y, b.min_z }, { b.min_x, b.max_y, b.min_z }, { b.min_x, b.max_y, b.max_z }, { b.min_x, b.min_y, b.max_z } } });
+    if (faces & Faces::PositiveX && eye.x > b.max_x)
+        RasterizeQuad({ { { b.max_x, b.min_y, b.min_z }, { b.max_x, b.max_y, b.min_z }, { b.max_x, b.max_y, b.max_z }, { b.max_x, b.min_y, b.max_z } } });
+    if (faces & Faces::NegativeZ && eye.z < b.min_z)
+        RasterizeQuad({ { { b.min_x, b.min_y, b.min_z }, { b.max_x, b.min_y, b.min_z }, { b.max_x, b.max_y, b.min_z }, { b.min_x, b.max_y, b.min_z } } });
+    if (faces & Faces::PositiveZ && eye.z > b.max_z)
+        RasterizeQuad({ { { b.min_x, b.min_y, b.max_z }, { b.max_x, b.min_y, b.max_z }, { b.max_x, b.max_y, b.max_z }, { b.min_x, b.max_y, b.max_z } } });
+}
+
+void OcclusionCuller::AddHeightfieldOccluder(const utils::vec2i& origin, int32_t cell_size, int32_t cells, std::span<const int32_t> heights)
+{
+    auto height_at = [&](int32_t cx, int32_t cz) {
+        if (cx < 0 || cz < 0 || cx >= cells || cz >= cells)
+            return std::numeric_limits<int32_t>::min();
+        return heights[cx * cells + cz];
+    };
+
+    for (int32_t cx = 0; cx < cells; ++cx)
+    {
+        for (int32_t cz = 0; cz < cells; ++cz)
+        {
+            auto top = height_at(cx, cz);
+            if (top <= 0)
+                continue;
+
+            // A side fully covered by the neighbouring cell can't be seen
+            uint32_t faces = Faces::Top;
+            if (height_at(cx - 1, cz) < top)
+                faces |= Faces::NegativeX;
+            if (height_at(cx + 1, cz) < top)
+                faces |= Faces::PositiveX;
+            if (height_at(cx, cz - 1) < top)
+                faces |= Faces::NegativeZ;
+            if (height_at(cx, cz + 1) < top)
+                faces |= Faces::PositiveZ;
+
+            auto x = static_cast<float>(origin.x + cx * cell_size);
+            auto z = static_cast<float>(origin.y + cz * cell_size);
+            AddOccluder({ x, 0.f, z, x + cell_size, static_cast<float>(top), z + cell_size }, faces);
+        }
+    }
+}
+
+void OcclusionCuller::RasterizeQuad(const std::array<std::array<float, 3>, 4>& corners)
+{
+    std::array<ScreenVertex, 4> screen;
+    float quad_depth = -g_far_depth;
+    for (size_t i = 0; i < corners.size(); ++i)
+    {
+        if (!Project(corners[i][0], corners[i][1], corners[i][2], screen[i]))
+            return;
+        quad_depth = std::max(quad_depth, screen[i].z);
+    }
+
+    RasterizeTriangle(screen[0], screen[1], screen[2], quad_depth);
+    RasterizeTriangle(screen[0], screen[2], screen[3], quad_depth);
+}
+
+void OcclusionCuller::RasterizeTriangle(ScreenVertex a, ScreenVertex b, ScreenVertex c, float triangle_depth)
+{
+    float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+    if (area == 0.f)
+        return;
+    if (area < 0.f)
+        std::swap(b, c);
+
+    int32_t min_x = std::max(0, static_cast<int32_t>(std::floor(std::min({ a.x, b.x, c.x }))));
+    int32_t max_x = std::min(width - 1, static_cast<int32_t>(std::ceil(std::max({ a.x, b.x, c.x }))));
+    int32_t min_y = std::max(0, static_cast<int32_t>(std::floor(std::min({ a.y, b.y, c.y }))));
+    int32_t max_y = std::min(height - 1, static_cast<int32_t>(std::ceil(std::max({ a.y, b.y, c.y }))));
+    if (min_x > max_x || min_y > max_y)
+        return;
+
+    // Edge functions e = A * x + B * y + C, non negative inside for every edge
+    struct Edge
+    {
+        float a, b, c;
+    };
+    auto make_edge = [](const ScreenVertex& v0, const ScreenVertex& v1) {
+        float a = v0.y - v1.y;
+        float b = v1.x - v0.x;
+        return Edge{ a, b, -(a * v0.x + b * v0.y) };
+    };
+    const std::array<Edge, 3> edges = { make_edge(a, b), make_edge(b, c), make_edge(c, a) };
+
+    min_x &= ~3;
+
+#ifdef OCCLUSION_CULLER_SSE
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 depth4 = _mm_set1_ps(triangle_depth);
+    const __m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+    __m128 edge_a[3];
+    for (size_t i = 0; i < edges.size(); ++i)
+        edge_a[i] = _mm_set1_ps(edges[i].a);
+
+    for (int32_t y = min_y; y <= max_y; ++y)
+    {
+        float py = y + 0.5f;
+        __m128 row[3];
+        for (size_t i = 0; i < edges.size(); ++i)
+            row[i] = _mm_set1_ps(edges[i].b * py + edges[i].c);
+
+        float* line = depth.data() + y * width;
+        for (int32_t x = min_x; x <= max_x; x += 4)
+        {
+            __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), offsets);
+            __m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edge_a[0], px), row[0]), zero);
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edge_a[1], px), row[1]), zero));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edge_a[2], px), row[2]), zero));
+
+            __m128 current = _mm_loadu_ps(line + x);
+            __m128 nearest = _mm_min_ps(current, depth4);
+            _mm_storeu_ps(line + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, current)));
+        }
+    }
+#else
+    for (int32_t y = min_y; y <= max_y; ++y)
+    {
+        float py = y + 0.5f;
+        float* line = depth.data() + y * width;
+        for (int32_t x = min_x; x <= max_x; ++x)
+        {
+            float px = x + 0.5f;
+            bool inside = true;
+            for (const auto& edge : edges)
+                inside = inside && edge.a * px + edge.b * py + edge.c >= 0.f;
+            if (inside)
+                line[x] = std::min(line[x], triangle_depth);
+        }
+    }
+#endif
+}
+
+void OcclusionCuller::Finish()
+{
+    const float* src = depth.data();
+    int32_t src_width = width;
+    int32_t src_height = height;
+    for (auto& level : levels)
+    {
+        // The last row and column repeat when the level above has an odd size
+        for (int32_t y = 0; y < level.height; ++y)
+        {
+            const float* line0 = src + std::min(2 * y, src_height - 1) * src_width;
+            const float* line1 = src + std::min(2 * y + 1, src_height - 1) * src_width;
+            float* res = level.depth.data() + y * level.width;
+            for (int32_t x = 0; x < level.width; ++x)
+            {
+                auto x0 = std::min(2 * x, src_width - 1);
+                auto x1 = std::min(2 * x + 1, src_width - 1);
+                res[x] = std::max(std::max(line0[x0], line0[x1]), std::max(line1[x0], line1[x1]));
+            }
+        }
+        src = level.depth.data();
+        src_width = level.width;
+        src_height = level.height;
+    }
+}
+
+bool OcclusionCuller::IsVisible(const Vulkan::BBox& box) const
+{
+    float min_x = g_far_depth;
+    float min_y = g_far_depth;
+    float max_x = -g_far_depth;
+    float max_y = -g_far_depth;
+    float nearest = g_far_depth;
+    for (uint32_t i = 0; i < 8u; ++i)
+    {
+        ScreenVertex v;
+        if (!Project(i & 1u ? box.max_x : box.min_x, i & 2u ? box.max_y : box.min_y, i & 4u ? box.max_z : box.min_z, v))
+            return true;
+
+        min_x = std::min(min_x, v.x);
+        min_y = std::min(min_y, v.y);
+        max_x = std::max(max_x, v.x);
+        max_y = std::max(max_y, v.y);
+        nearest = std::min(nearest, v.z);
+    }
+
+    if (max_x < 0.f || max_y < 0.f || min_x > width || min_y > height)
+        return true;
+
+    // A texel of level i covers 2^(i + 1) pixels, the rect spans at most 2 of them plus the one it starts in
+    size_t level_index = 0;
+    float size = std::max(max_x - min_x, max_y - min_y);
+    while (level_index + 1 < levels.size() && size > 2.f * static_cast<float>(2 << level_index))
+        ++level_index;
+
+    const auto& level = levels[level_index];
+    int32_t texel_size = 2 << level_index;
+    int32_t texel_min_x = std::clamp(static_cast<int32_t>(min_x), 0, width - 1) / texel_size;
+    int32_t texel_min_y = std::clamp(static_cast<int32_t>(min_y), 0, height - 1) / texel_size;
+    int32_t texel_max_x = std::min(width - 1, static_cast<int32_t>(max_x)) / texel_size;
+    int32_t texel_max_y = std::min(height - 1, static_cast<int32_t>(max_y)) / texel_size;
+    for (int32_t ty = texel_min_y; ty <= texel_max_y; ++ty)
+    {
+        for (int32_t tx = texel_min_x; tx <= texel_max_x; ++tx)
+        {
+            if (level.depth[ty * level.width + tx] >= nearest)
+                return true;
+        }
+    }
+    return false;
+}
+
+}
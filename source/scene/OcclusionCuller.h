@@ -0,0 +1,79 @@
+#pragma once
+
+#include <ICamera.h>
+
+#include <array>
+#include <span>
+#include <vector>
+
+#include "ChunkUtils.h"
+
+namespace Scene
+{
+
+// Software depth buffer for terrain occlusion. Occluders must lie inside solid terrain,
+// every face is written with its farthest depth, so the buffer never hides more than
+// the real geometry does. Boxes are tested against a max depth pyramid of the buffer,
+// at the level where their screen rect covers about 2x2 texels.
+class OcclusionCuller
+{
+public:
+    static constexpr int32_t width = 256;
+    static constexpr int32_t height = 128;
+
+    enum Faces : uint32_t
+    {
+        NegativeX = 1u << 0u,
+        PositiveX = 1u << 1u,
+        NegativeZ = 1u << 2u,
+        PositiveZ = 1u << 3u,
+        Top       = 1u << 4u,
+        All       = NegativeX | PositiveX | NegativeZ | PositiveZ | Top,
+    };
+
+    OcclusionCuller();
+
+    void Begin(const std::array<float, 16>& view_projection, const Vulkan::Vector3f& eye);
+
+    void AddOccluder(const Vulkan::BBox& box, uint32_t faces = Faces::All);
+
+    // Solid columns from y = 0 to the height of each cell, heights are cells x cells, x major
+    void AddHeightfieldOccluder(const utils::vec2i& origin, int32_t cell_size, int32_t cells, std::span<const int32_t> heights);
+
+    // Builds the max depth pyramid, call after the last occluder
+    void Finish();
+
+    bool IsVisible(const Vulkan::BBox& box) const;
+
+    float GetDepth(int32_t x, int32_t y) const { return depth[y * width + x]; }
+    // Level 0 is half the buffer size, every level halves the previous one down to a single texel
+    size_t GetLevelCount() const { return levels.size(); }
+    float GetMaxDepth(size_t level, int32_t x, int32_t y) const { return levels[level].depth[y * levels[level].width + x]; }
+
+private:
+    struct ScreenVertex
+    {
+        float x = 0.f;
+        float y = 0.f;
+        float z = 0.f;
+    };
+
+    bool Project(float x, float y, float z, ScreenVertex& res) const;
+    void RasterizeQuad(const std::array<std::array<float, 3>, 4>& corners);
+    void RasterizeTriangle(ScreenVertex a, ScreenVertex b, ScreenVertex c, float triangle_depth);
+
+    std::array<float, 16> matrix{};
+    Vulkan::Vector3f      eye{};
+
+    struct DepthLevel
+    {
+        int32_t            width = 0;
+        int32_t            height = 0;
+        std::vector<float> depth;
+    };
+
+    std::vector<float>      depth;
+    std::vector<DepthLevel> levels;
+};
+
+}
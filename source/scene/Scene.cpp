@@ -1,49 +1,55 @@
 #include <IFactory.h>
 #include <ICamera.h>
-#include <DataProvider.h>
+#include <Profiler.h>
 
 #include "IScene.h"
 #include "IResourceLoader.h"
 
 #include "Chunk.h"
 #include "ChunkStorage.h"
+#include "FrameStats.h"
+#include "OcclusionCuller.h"
 #include "Texture.h"
 #include "Shader.h"
 #include "ThreadUtils.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <future>
+
 namespace Scene
 {
 
-enum class Corner : uint32_t
-{
-    TopLeft = 0,
-    BotLeft,
-    BotRight,
-    TopRight,
-};
+// Two triangles per face, block.vert looks the corner of gl_VertexIndex up in a table
+constexpr uint32_t g_face_vertex_count = 6;
 
-static const std::vector<Corner> g_vertices = {
-    Corner::TopLeft,
-    Corner::BotLeft,
-    Corner::BotRight,
-    Corner::TopRight,
-};
+constexpr uint32_t g_texture_type_count = static_cast<uint32_t>(TextureType::Count);
 
-static const std::vector<uint32_t> g_indices = {
-    0,1,2, 2,3,0,
-};
+// Sorting the samples is cheap but not free, percentiles lag behind by at most this many frames
+constexpr uint64_t g_percentiles_period = 30u;
 
-static const Vulkan::Attributes g_vertex_attribs = {
-    Vulkan::AttributeFormat::vec1i
-};
+// Only the terrain around the camera is big enough on screen to hide anything
+constexpr int32_t g_occluder_distance = 3;
 
-static const Vulkan::Attributes g_instance_attributes = {
-    Vulkan::AttributeFormat::vec3f,
-    Vulkan::AttributeFormat::vec1i,
-    Vulkan::AttributeFormat::vec1i,
-};
+// Everything the block pipeline needs. The texture upload and the pipeline compilation only touch
+// factory containers the render thread leaves alone, so they are built on a worker while it streams chunks.
+// Its staging buffers retire through the upload batch, they are freed only after the batch with their copies.
+struct BlockResources
+{
+    BlockResources(Vulkan::ICamera& camera, const IResourceLoader& loader, Vulkan::IFactory& factory, const Vulkan::IVertexLayout& vertex_layout)
+        : textures      (TextureType::First, g_texture_type_count, loader, factory)
+        , program       (ShaderTarget::Block, loader, factory)
+        , descriptor_set(factory.CreateDescriptorSet(Vulkan::InputResources{ camera.GetMvpLayout(), textures.GetTexture() }))
+        , pipeline      (factory.CreatePipeline(descriptor_set, program.GetShaders(), vertex_layout))
+    {
+    }
 
-constexpr uint32_t g_texture_type_count = static_cast<uint32_t>(TextureType::Count);
+    Texture                       textures;
+    Program                       program;
+    const Vulkan::IDescriptorSet& descriptor_set;
+    const Vulkan::IPipeline&      pipeline;
+};
 
 class Scene : public IScene
 {
@@ -52,25 +58,13 @@ class Scene : public IScene
     std::unique_ptr<IResourceLoader>  loader;
     std::unique_ptr<IChunkStorage>    chunk_storage;
 
-    Texture textures;
-    Program solid_block_program;
-
+    // No vertex input, the instances are pulled from their storage buffers
     const Vulkan::IVertexLayout& vertex_layout = [](Vulkan::IFactory& factory) {
         std::reference_wrapper<Vulkan::IVertexLayout> res = factory.AddVertexLayout();
-        auto& vertex = res.get().AddVertexBinding();
-        for (auto& attrib : g_vertex_attribs)
-            vertex.AddAttribute(attrib);
-        auto& instance = res.get().AddInstanceBinding();
-        for (auto& attrib : g_instance_attributes)
-            instance.AddAttribute(attrib);
+        res.get().SetVertexCount(g_face_vertex_count);
         return res;
     }(*factory);
 
-    const Vulkan::IBuffer&        index_buffer;
-    const Vulkan::IBuffer&        vertex_buffer;
-    const Vulkan::IDescriptorSet& descriptor_set;
-    const Vulkan::IPipeline&      pipeline;
-
     uint32_t thread_count = 1;// std::thread::hardware_concurrency();
     std::vector<utils::SimpleThread::Ptr> draw_threads = [](uint32_t thread_count)
     {
@@ -89,10 +83,22 @@ class Scene : public IScene
         return command_buffers;
     }(*factory, camera, thread_count);
 
+    using ChunkRef = std::reference_wrapper<const Chunk>;
+    std::vector<ChunkRef> chunks;
+    std::vector<ChunkRef> water_chunks;
+
+    OcclusionCuller occlusion;
+    uint32_t        occluded_cnt = 0;
+
     std::string info = "";
 
-    uint64_t frame = 0u;
-    uint64_t time_diff = 0u;
+    uint64_t   frame = 0u;
+    SceneStats stats;
+    std::array<utils::RollingPercentiles<SceneStats::window>, static_cast<size_t>(FramePhase::Count)> phase_samples;
+
+    std::unique_ptr<BlockResources>              resources;
+    // Destroyed first, waits for the worker if it is still building the resources
+    std::future<std::unique_ptr<BlockResources>> pending_resources;
 
 public:
     Scene(Vulkan::ICamera& camera, std::unique_ptr<Vulkan::IFactory> fac, std::unique_ptr<IResourceLoader> load)
@@ -100,92 +106,185 @@ public:
         , factory(std::move(fac))
         , loader(std::move(load))
         , chunk_storage(IChunkStorage::Create(camera, *factory))
-        , textures(TextureType::First, g_texture_type_count, *loader, *factory)
-        , solid_block_program(ShaderTarget::Block, *loader, *factory)
-        , vertex_buffer (factory->AddBuffer(Vulkan::BufferUsage::Vertex, Vulkan::BufferDataOwner<Corner>(g_vertices)))
-        , index_buffer  (factory->AddBuffer(Vulkan::BufferUsage::Index, Vulkan::BufferDataOwner<uint32_t>(g_indices)))
-        , descriptor_set(factory->CreateDescriptorSet(Vulkan::InputResources{ camera.GetMvpLayout(), textures.GetTexture() }))
-        , pipeline      (factory->CreatePipeline(descriptor_set, solid_block_program.GetShaders(), vertex_layout))
     {
+        pending_resources = std::async(std::launch::async, [this]() {
+            PROFILE_ZONE("Scene resources");
+            return std::make_unique<BlockResources>(this->camera, *loader, *factory, vertex_layout);
+        });
     }
 
     ~Scene() override = default;
 
     void Render() override
     {
-        auto render_begin = std::chrono::high_resolution_clock::now();
-
-        std::atomic_uint32_t draw_cnt = 0;
-        std::vector<std::reference_wrapper<const Chunk>> frustrum_passed_water_chunks;
-        std::mutex water_mutex;
+        PROFILE_ZONE("Scene::Render");
+        utils::Stopwatch frame_stopwatch;
+        utils::Stopwatch stopwatch;
 
         chunk_storage->OnRender();
+        const auto& storage_stats = chunk_storage->GetStats();
+        // The storage times both of its phases itself, skip them on the scene stopwatch
+        stopwatch.Lap();
+
+        // Frames before the block pipeline is built only clear the screen. Checked before the render pass
+        // submits the upload batch, so the texture copies of the worker go with the first frame using them
+        chunks.clear();
+        if (ResourcesReady())
+        {
+            chunk_storage->ForEachVisible([&](const Chunk& chunk)
+            {
+                chunks.emplace_back(chunk);
+            });
+        }
+        stats.chunks_visible = static_cast<uint32_t>(chunks.size());
 
         {
-            auto render_pass = factory->CreateRenderPass(camera);
+            PROFILE_ZONE("Occlusion culling");
+            CullOccluded();
+        }
+        auto culling_time = stopwatch.Lap();
 
-            for (uint32_t i = 0; i < thread_count; ++i)
-            {
-                auto& command_buffer = command_buffers.at(i).get();
-                render_pass->AddCommandBuffer(command_buffer);
+        uint32_t draw_cnt = 0;
+        uint64_t instances = 0;
+        auto render_pass = factory->CreateRenderPass(camera);
 
-                command_buffer.Bind(descriptor_set);
-                command_buffer.Bind(pipeline);
-                command_buffer.Bind(index_buffer);
-                command_buffer.Bind(vertex_buffer);
-            }
+        for (uint32_t i = 0; resources && i < thread_count; ++i)
+        {
+            auto& command_buffer = command_buffers.at(i).get();
+            render_pass->AddCommandBuffer(command_buffer);
+
+            command_buffer.Bind(resources->descriptor_set);
+            command_buffer.Bind(resources->pipeline);
+        }
 
-            size_t thread_index = 0u;
-            chunk_storage->ForEach([&](const Chunk& chunk)
+        {
+            PROFILE_ZONE("Recording");
+            water_chunks.clear();
+            for (const auto& chunk_ref : chunks)
             {
-                draw_threads[thread_index++ % thread_count]->Add(std::bind([&](size_t thread_index) {
-                    const auto& bbox = chunk.GetBBox();
-                    if (!camera.ObjectVisible(Vulkan::BBox{
-                        static_cast<float>(bbox.first.x),
-                        static_cast<float>(bbox.first.y),
-                        static_cast<float>(bbox.first.z),
-                        static_cast<float>(bbox.second.x),
-                        static_cast<float>(bbox.second.y),
-                        static_cast<float>(bbox.second.z),
-                        }))
-                        return;
-
-                    ++draw_cnt;
-                    command_buffers[thread_index].get().Draw(chunk.GetData(), chunk.GetWaterOffset());
-                    if (!chunk.HasWater())
-                        return;
-
-                    std::lock_guard lock(water_mutex);
-                    frustrum_passed_water_chunks.emplace_back(chunk);
-                }, thread_index++ % thread_count));
-            });
+                const auto& chunk = chunk_ref.get();
+                instances += chunk.GetGpuSize() + chunk.GetWaterSize();
+                if (chunk.HasWater())
+                    water_chunks.emplace_back(chunk);
+
+                if (!chunk.HasCubes())
+                    continue;
+
+                auto thread_index = draw_cnt++ % thread_count;
+                draw_threads[thread_index]->Add([this, &chunk, thread_index]() {
+                    chunk.Draw(command_buffers[thread_index]);
+                });
+            }
 
             for (auto& draw_thread : draw_threads)
             {
+                PROFILE_ZONE("Wait draw threads");
                 draw_thread->Wait();
             }
 
-            for (const auto& chunk : frustrum_passed_water_chunks)
+            for (const auto& chunk : water_chunks)
             {
-                command_buffers.back().get().Draw(
-                    chunk.get().GetData(),
-                    chunk.get().GetGpuSize() - chunk.get().GetWaterOffset(),
-                    chunk.get().GetWaterOffset()
-                );
+                chunk.get().DrawWater(command_buffers.back());
             }
         }
+        auto recording_time = stopwatch.Lap();
 
-        auto render_end = std::chrono::high_resolution_clock::now();
-        if (frame++ % 30 == 0)
-            time_diff = std::chrono::duration_cast<std::chrono::microseconds>(render_end - render_begin).count();
-
-        info = " - " + std::to_string(draw_cnt) + " chunks " + " - CPU frame time - " + std::to_string(time_diff);
+        // Executes the secondary command buffers and ends the pass
+        {
+            PROFILE_ZONE("Submit");
+            render_pass.reset();
+        }
+        auto submit_time = stopwatch.Lap();
+
+        stats.frame = frame++;
+        stats.chunks_loaded = storage_stats.chunks_loaded;
+        stats.chunks_drawn = draw_cnt;
+        stats.instances = instances;
+        stats.uploads = storage_stats.uploads;
+        stats.pending_chunks = storage_stats.pending_chunks;
+        stats.pending_remeshes = storage_stats.pending_remeshes;
+        stats.pending_gpu_tasks = storage_stats.pending_gpu_tasks;
+
+        AddTiming(FramePhase::StorageUpdate, storage_stats.update_time);
+        AddTiming(FramePhase::CompletionDrain, storage_stats.drain_time);
+        AddTiming(FramePhase::Culling, culling_time);
+        AddTiming(FramePhase::Recording, recording_time);
+        AddTiming(FramePhase::Submit, submit_time);
+        AddTiming(FramePhase::Frame, frame_stopwatch.Lap());
+
+        if (stats.frame % g_percentiles_period == 0)
+            UpdatePercentiles();
+
+        const auto& frame_timing = stats.Get(FramePhase::Frame);
+        info = " - " + std::to_string(draw_cnt) + " chunks " + " - " + std::to_string(occluded_cnt) + " occluded"
+            + " - CPU frame time p50/p99 - " + std::to_string(frame_timing.p50) + "/" + std::to_string(frame_timing.p99);
     }
 
     const std::string& GetInfo() const override
     {
         return info;
     }
+
+    const SceneStats& GetStats() const override
+    {
+        return stats;
+    }
+
+private:
+    bool ResourcesReady()
+    {
+        if (!resources && pending_resources.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+            resources = pending_resources.get();
+        return !!resources;
+    }
+
+    void AddTiming(FramePhase phase, uint64_t time)
+    {
+        auto index = static_cast<size_t>(phase);
+        stats.phases[index].last = time;
+        phase_samples[index].Add(time);
+    }
+
+    void UpdatePercentiles()
+    {
+        for (size_t i = 0; i < phase_samples.size(); ++i)
+        {
+            auto [p50, p95, p99] = phase_samples[i].Get(std::array{ 50.0, 95.0, 99.0 });
+            stats.phases[i].p50 = p50;
+            stats.phases[i].p95 = p95;
+            stats.phases[i].p99 = p99;
+        }
+    }
+
+    void CullOccluded()
+    {
+        auto eye = camera.GetViewPos();
+        auto eye_chunk = WorldToChunk(utils::vec2i(static_cast<int32_t>(std::floor(eye.x)), static_cast<int32_t>(std::floor(eye.z))));
+
+        occlusion.Begin(camera.GetViewProjection(), eye);
+        for (const auto& chunk_ref : chunks)
+        {
+            const auto& bbox = chunk_ref.get().GetBBox();
+            auto pos = WorldToChunk(utils::vec2i(bbox.first.x, bbox.first.z));
+            if (std::abs(pos.x - eye_chunk.x) > g_occluder_distance || std::abs(pos.y - eye_chunk.y) > g_occluder_distance)
+                continue;
+
+            const auto& heights = chunk_ref.get().GetOccluderHeights();
+            occlusion.AddHeightfieldOccluder(
+                { pos.x * g_chunk_size, pos.y * g_chunk_size },
+                g_chunk_size / Chunk::occluder_cells,
+                Chunk::occluder_cells,
+                heights
+            );
+        }
+        occlusion.Finish();
+
+        auto visible_end = std::remove_if(chunks.begin(), chunks.end(), [this](const ChunkRef& chunk) {
+            return !occlusion.IsVisible(ToBBox(chunk.get().GetBBox()));
+        });
+        occluded_cnt = static_cast<uint32_t>(std::distance(visible_end, chunks.end()));
+        chunks.erase(visible_end, chunks.end());
+    }
 };
 
 std::unique_ptr<IScene> IScene::Create(Vulkan::ICamera& camera, std::unique_ptr<Vulkan::IFactory> factory, std::unique_ptr<IResourceLoader> loader)
@@ -0,0 +1,109 @@
+#include <Noise.h>
+
+#include "Structures.h"
+
+namespace Scene
+{
+
+constexpr int32_t g_max_structure_radius = 2;
+
+utils::vec2i ChunkToRegion(const utils::vec2i& chunk)
+{
+    return { utils::FloorDiv(chunk.x, StructureCache::region_size), utils::FloorDiv(chunk.y, StructureCache::region_size) };
+}
+
+bool Intersects(const std::pair<Point3D, Point3D>& bbox, int32_t min_x, int32_t min_z, int32_t max_x, int32_t max_z)
+{
+    return bbox.first.x < max_x && bbox.second.x > min_x && bbox.first.z < max_z && bbox.second.z > min_z;
+}
+
+StructureCache::StructureCache(const INoise& noiser, int32_t keep_distance)
+    : noiser(noiser)
+    , keep_distance(keep_distance / region_size + 2)
+{
+}
+
+Structures StructureCache::Query(const utils::vec2i& chunk)
+{
+    int32_t min_x = chunk.x * g_chunk_size;
+    int32_t min_z = chunk.y * g_chunk_size;
+    int32_t max_x = min_x + g_chunk_size;
+    int32_t max_z = min_z + g_chunk_size;
+
+    auto first = ChunkToRegion(WorldToChunk({ min_x - g_max_structure_radius, min_z - g_max_structure_radius }));
+    auto last = ChunkToRegion(WorldToChunk({ max_x + g_max_structure_radius, max_z + g_max_structure_radius }));
+
+    Structures res;
+    for (int32_t x = first.x; x <= last.x; ++x)
+    {
+        for (int32_t z = first.y; z <= last.y; ++z)
+        {
+            // Held here, the cache may evict the region while it is read
+            auto region = GetRegion({ x, z });
+            for (const auto& structure : region.get())
+            {
+                if (Intersects(structure.bbox, min_x, min_z, max_x, max_z))
+                    res.push_back(structure);
+            }
+        }
+    }
+    return res;
+}
+
+StructureCache::Region StructureCache::GetRegion(const utils::vec2i& region)
+{
+    std::promise<Structures> promise;
+    Region res = promise.get_future().share();
+    {
+        std::lock_guard lock(regions_mutex);
+        auto it = regions.find(region);
+        if (it != regions.end())
+            return it->second;
+
+        std::erase_if(regions, [&](const auto& cached) {
+            auto diff = cached.first - region;
+            return std::max(std::abs(diff.x), std::abs(diff.y)) > keep_distance;
+        });
+        regions.emplace(region, res);
+    }
+
+    try
+    {
+        promise.set_value(CreateRegion(region));
+    }
+    catch (...)
+    {
+        promise.set_exception(std::current_exception());
+    }
+    return res;
+}
+
+Structures StructureCache::CreateRegion(const utils::vec2i& region) const
+{
+    constexpr int32_t size = region_size * g_chunk_size;
+    constexpr int32_t tree_height = 6;
+
+    Structures res;
+    for (int32_t x = region.x * size; x < region.x * size + size; ++x)
+    {
+        for (int32_t z = region.y * size; z < region.y * size + size; ++z)
+        {
+            if (!noiser.IsTree(x, z))
+                continue;
+
+            int32_t y = noiser.GetHeight(x, z);
+            if (y <= static_cast<int32_t>(g_grass_bottom) || y > static_cast<int32_t>(g_grass_top))
+                continue;
+
+            Structure tree;
+            tree.type = StructureType::Tree;
+            tree.origin = { x, y, z };
+            tree.bbox.first = { x - g_max_structure_radius, y, z - g_max_structure_radius };
+            tree.bbox.second = { x + g_max_structure_radius + 1, y + tree_height, z + g_max_structure_radius + 1 };
+            res.push_back(tree);
+        }
+    }
+    return res;
+}
+
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <future>
+#include <vector>
+
+#include "Chunk.h"
+
+struct INoise;
+
+namespace Scene
+{
+
+enum class StructureType : uint32_t
+{
+    Tree = 0u,
+};
+
+struct Structure
+{
+    StructureType               type = StructureType::Tree;
+    Point3D                     origin{};
+    std::pair<Point3D, Point3D> bbox{}; // max is exclusive
+};
+
+using Structures = std::vector<Structure>;
+
+// Places structures once per region of region_size x region_size chunks, so a
+// structure crossing chunk borders is known to every chunk it touches.
+class StructureCache
+{
+public:
+    static constexpr int32_t region_size = 4;
+
+    StructureCache(const INoise& noiser, int32_t keep_distance);
+
+    // Structures whose footprint intersects the chunk, safe to call from any thread
+    Structures Query(const utils::vec2i& chunk);
+
+private:
+    using Region = std::shared_future<Structures>;
+
+    Region GetRegion(const utils::vec2i& region);
+    Structures CreateRegion(const utils::vec2i& region) const;
+
+    const INoise& noiser;
+    int32_t       keep_distance = 0;
+
+    std::map<utils::vec2i, Region> regions;
+    std::mutex                     regions_mutex;
+};
+
+}
@@ -1,8 +1,10 @@
 #include <DataProvider.h>
 #include <IFactory.h>
+#include <future>
 #include <stdexcept>
 
 #include "IResourceLoader.h"
+#include "MipChain.h"
 #include "Texture.h"
 
 namespace Scene
@@ -11,23 +13,51 @@ namespace Scene
 class TextureSource
     : public Vulkan::IDataProvider
 {
+    struct Layer
+    {
+        std::vector<uint8_t> data;
+        uint32_t width  = 0u;
+        uint32_t height = 0u;
+    };
+
     std::vector<uint8_t> data;
     uint32_t width  = 0u;
     uint32_t height = 1u;
     uint32_t depth  = 1u;
+    uint32_t levels = 1u;
 
 public:
     TextureSource(TextureType first, uint32_t count, const IResourceLoader& loader)
         : depth(count)
     {
+        // Layers are decoded in parallel, one task each
+        std::vector<std::future<Layer>> layers;
         for (uint32_t i = 0; i < count; ++i)
         {
             auto type_index = static_cast<uint32_t>(first) + i;
             if (type_index >= static_cast<uint32_t>(TextureType::Count))
                 throw std::out_of_range("TextureType");
 
-            loader.LoadTexture(static_cast<TextureType>(type_index), width, height, data);
+            layers.emplace_back(std::async(std::launch::async, [&loader, type = static_cast<TextureType>(type_index)]() {
+                Layer layer;
+                loader.LoadTexture(type, layer.width, layer.height, layer.data);
+                return layer;
+            }));
         }
+
+        for (auto& future : layers)
+        {
+            auto layer = future.get();
+            if (!data.empty() && (layer.width != width || layer.height != height))
+                throw std::runtime_error("Texture layers differ in size");
+
+            width = layer.width;
+            height = layer.height;
+            data.insert(data.end(), layer.data.begin(), layer.data.end());
+        }
+
+        data = BuildMipChain(data, width, height, depth);
+        levels = Scene::GetMipLevels(width, height);
     }
 
     ~TextureSource() override = default;
@@ -56,11 +86,21 @@ public:
     {
         return depth;
     }
+
+    uint32_t GetMipLevels() const override
+    {
+        return levels;
+    }
 };
 
 
+std::unique_ptr<Vulkan::IDataProvider> DecodeTextureArray(TextureType first, uint32_t count, const IResourceLoader& loader)
+{
+    return std::make_unique<TextureSource>(first, count, loader);
+}
+
 Texture::Texture(TextureType first, uint32_t count, const IResourceLoader& loader, Vulkan::IFactory& factory)
-    : texture(factory.CreateTexture(TextureSource(first, count, loader)))
+    : texture(factory.CreateTexture(*loader.LoadTextureArray(first, count)))
     , offset(static_cast<uint32_t>(first))
 {
 }
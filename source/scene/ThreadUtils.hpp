@@ -1,12 +1,21 @@
 #pragma once
 #include <map>
 #include <deque>
+#include <array>
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <limits>
 #include <cstdint>
+#include <functional>
 #include <mutex>
 #include <condition_variable>
 #include <algorithm>
 #include <future>
 
+#include <Profiler.h>
+
 namespace Scene
 {
 namespace utils
@@ -27,48 +36,115 @@ struct BoolScopeGuard
     }
 };
 
+// A task of DefferedExecutor, the handle returned by Add cancels it
+struct DefferedTask
+{
+    enum class State : uint32_t
+    {
+        Pending,
+        Running,
+        Done,
+        Cancelled,
+    };
+
+    std::atomic<State>    state = State::Pending;
+    uint64_t              execution_time = 0u;
+    std::function<void()> task;
+
+    // Owned by the submission queue until Execute takes it
+    std::shared_ptr<DefferedTask> self;
+    DefferedTask*                 next = nullptr;
+};
+
+using DefferedTaskHandle = std::shared_ptr<DefferedTask>;
+
+// Tasks run on the thread calling Execute, delays count Execute calls by their time.
+// Add and Remove never wait for Execute: new tasks go to a lock free stack that Execute
+// takes whole, then to a timing wheel slot of their execution time, or to the overflow
+// list when they are more than wheel_size frames away.
 struct DefferedExecutor
 {
     static constexpr uint64_t immediate = 0u;
+    static constexpr uint64_t wheel_size = 64u;
 
-    uint64_t Add(uint64_t delay, std::function<void()>&& task)
+    // Any thread, runs in the first Execute with a time of at least the last executed time + delay
+    DefferedTaskHandle Add(uint64_t delay, std::function<void()>&& task)
     {
-        std::unique_lock lock(tasks_mutex);
-        while (executig)
-            condition_variable.wait(lock);
-
-        auto id = unique_id++;
-        tasks.emplace(std::piecewise_construct, std::forward_as_tuple(id), std::forward_as_tuple(prev_time + delay, std::move(task)));
-        return id;
+        auto res = std::make_shared<DefferedTask>();
+        res->execution_time = prev_time.load(std::memory_order_relaxed) + delay;
+        res->task = std::move(task);
+        res->self = res;
+        pending.fetch_add(1u, std::memory_order_relaxed);
+
+        auto head = submitted.load(std::memory_order_relaxed);
+        do
+        {
+            res->next = head;
+        }
+        while (!submitted.compare_exchange_weak(head, res.get(), std::memory_order_release, std::memory_order_relaxed));
+        return res;
     }
 
-    void Remove(uint64_t id)
+    // Any thread, the task won't run once this returns. Waits only when Execute is running this very task.
+    void Remove(const DefferedTaskHandle& handle)
     {
-        std::unique_lock lock(tasks_mutex);
-        while (executig)
-            condition_variable.wait(lock);
+        if (!handle)
+            return;
 
-        auto task_it = tasks.find(id);
-        if (task_it == tasks.end())
+        auto expected = DefferedTask::State::Pending;
+        if (handle->state.compare_exchange_strong(expected, DefferedTask::State::Cancelled, std::memory_order_acquire))
+        {
+            // Execute never touches the function of a cancelled task
+            handle->task = {};
+            pending.fetch_sub(1u, std::memory_order_relaxed);
             return;
+        }
 
-        task_it->second.task = {};
-        tasks.erase(task_it);
+        while (handle->state.load(std::memory_order_acquire) == DefferedTask::State::Running)
+            std::this_thread::yield();
     }
 
-    void Execute(uint64_t time)
+    // One thread at a time. Returns the number of executed tasks.
+    size_t Execute(uint64_t time)
     {
+        PROFILE_ZONE("DefferedExecutor::Execute");
+        TakeSubmitted(time);
+
+        auto last_time = prev_time.load(std::memory_order_relaxed);
+        if (time > last_time)
         {
-            BoolScopeGuard guard(executig);
-            executig = true;
-
-            std::unique_lock lock(tasks_mutex);
-            std::erase_if(tasks, [time](const auto& task) {
-                return task.second.execution_time <= time;
-            });
-            prev_time = time;
+            auto frames = std::min(time - last_time, wheel_size);
+            for (uint64_t frame = last_time + 1u; frame <= last_time + frames; ++frame)
+            {
+                auto& slot = wheel[frame % wheel_size];
+                std::erase_if(slot, [&](DefferedTaskHandle& task) {
+                    if (task->execution_time > time)
+                        return false;
+                    ready.emplace_back(std::move(task));
+                    return true;
+                });
+            }
         }
-        condition_variable.notify_all();
+
+        std::erase_if(overflow, [&](DefferedTaskHandle& task) {
+            if (task->execution_time > time && task->execution_time - time >= wheel_size)
+                return false;
+            Schedule(std::move(task), time);
+            return true;
+        });
+        prev_time.store(time, std::memory_order_relaxed);
+
+        size_t res = 0;
+        for (auto& task : ready)
+            res += Run(*task);
+        ready.clear();
+        return res;
+    }
+
+    // Tasks neither run nor cancelled yet
+    size_t Size() const
+    {
+        return pending.load(std::memory_order_relaxed);
     }
 
     ~DefferedExecutor()
@@ -77,47 +153,63 @@ struct DefferedExecutor
     }
 
 private:
-    struct TaskWrapper
+    void TakeSubmitted(uint64_t time)
     {
-        uint64_t execution_time = 0u;
-        std::function<void()> task;
-
-        TaskWrapper(uint64_t et, std::function<void()>&& t)
-            : execution_time(et)
-            , task(std::move(t))
+        // The stack is newest first, reverse it so tasks of a frame run in submission order
+        DefferedTask* head = submitted.exchange(nullptr, std::memory_order_acquire);
+        DefferedTask* fifo = nullptr;
+        while (head)
         {
+            auto next = head->next;
+            head->next = fifo;
+            fifo = head;
+            head = next;
         }
 
-        TaskWrapper(TaskWrapper&& r)
-            : execution_time(r.execution_time)
+        while (fifo)
         {
-            task.swap(r.task);
+            auto next = fifo->next;
+            fifo->next = nullptr;
+            Schedule(std::move(fifo->self), time);
+            fifo = next;
         }
+    }
 
-        TaskWrapper& operator=(TaskWrapper&& r)
-        {
-            execution_time = r.execution_time;
-            task.swap(r.task);
-            return *this;
-        }
+    void Schedule(DefferedTaskHandle&& task, uint64_t time)
+    {
+        if (task->state.load(std::memory_order_relaxed) == DefferedTask::State::Cancelled)
+            return;
 
-        ~TaskWrapper()
-        {
-            if (task)
-                task();
-        }
+        if (task->execution_time <= time)
+            ready.emplace_back(std::move(task));
+        else if (task->execution_time - time < wheel_size)
+            wheel[task->execution_time % wheel_size].emplace_back(std::move(task));
+        else
+            overflow.emplace_back(std::move(task));
+    }
 
-        TaskWrapper(const TaskWrapper&) = delete;
-        TaskWrapper& operator=(const TaskWrapper&) = delete;
-    };
+    bool Run(DefferedTask& task)
+    {
+        auto expected = DefferedTask::State::Pending;
+        if (!task.state.compare_exchange_strong(expected, DefferedTask::State::Running, std::memory_order_acquire))
+            return false;
+
+        // Destroying the function is part of the task, captures may hold resources to release
+        task.task();
+        task.task = {};
+        task.state.store(DefferedTask::State::Done, std::memory_order_release);
+        pending.fetch_sub(1u, std::memory_order_relaxed);
+        return true;
+    }
 
-    uint64_t prev_time = 0u;
-    uint64_t unique_id = 0u;
-    std::map<uint64_t, TaskWrapper> tasks;
+    std::atomic<uint64_t>      prev_time = 0u;
+    std::atomic<size_t>        pending = 0u;
+    std::atomic<DefferedTask*> submitted = nullptr;
 
-    std::mutex               tasks_mutex;
-    std::condition_variable  condition_variable;
-    bool executig = false;
+    // Execute thread only
+    std::array<std::vector<DefferedTaskHandle>, wheel_size> wheel;
+    std::vector<DefferedTaskHandle>                         overflow;
+    std::vector<DefferedTaskHandle>                         ready;
 };
 
 template <typename T>
@@ -160,6 +252,7 @@ private:
 
     void ExecutionThread()
     {
+        PROFILE_THREAD("PriorityExecutor worker");
         while (!terminated)
         {
             Task task;
@@ -226,6 +319,7 @@ struct SimpleThread
 private:
     void ExecutionThread()
     {
+        PROFILE_THREAD("SimpleThread");
         while (!terminated)
         {
             std::unique_lock<std::mutex> lock(tasks_mutex);
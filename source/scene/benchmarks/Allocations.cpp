@@ -0,0 +1,65 @@
+#include "Allocations.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+
+std::atomic_uint64_t g_allocation_count = 0u;
+std::atomic_uint64_t g_allocated_bytes = 0u;
+
+void* Allocate(std::size_t size)
+{
+    g_allocation_count.fetch_add(1u, std::memory_order_relaxed);
+    g_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (auto ptr = std::malloc(size ? size : 1u))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+}
+
+void* operator new(std::size_t size)
+{
+    return Allocate(size);
+}
+
+void* operator new[](std::size_t size)
+{
+    return Allocate(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+namespace Scene
+{
+namespace benchmarks
+{
+
+Allocations Allocations::Get()
+{
+    return { g_allocation_count.load(std::memory_order_relaxed), g_allocated_bytes.load(std::memory_order_relaxed) };
+}
+
+}
+}
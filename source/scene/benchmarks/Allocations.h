@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Scene
+{
+namespace benchmarks
+{
+
+// Totals of the global operator new replaced in Allocations.cpp, all threads included
+struct Allocations
+{
+    uint64_t count = 0u;
+    uint64_t bytes = 0u;
+
+    static Allocations Get();
+};
+
+}
+}
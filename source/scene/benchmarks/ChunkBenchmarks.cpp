@@ -0,0 +1,160 @@
+#include <benchmark/benchmark.h>
+
+#include <IFactory.h>
+#include <Noise.h>
+
+#include "Chunk.h"
+#include "Structures.h"
+#include "ThreadUtils.hpp"
+#include "Allocations.h"
+
+using Scene::utils::vec2i;
+
+namespace
+{
+
+enum class Landscape
+{
+    Ocean,
+    Forest,
+    Ridge,
+};
+
+// Seed and search area are fixed, so every run measures the same chunks
+struct World
+{
+    static constexpr int32_t search_distance = 24;
+    static constexpr int32_t sample_step = 4;
+
+    Vulkan::RecordingStats            recording;
+    std::unique_ptr<Vulkan::IFactory> factory = CreateRecordingFactory(recording);
+    std::unique_ptr<INoise>           noiser = INoise::CreateNoise(213312, 0.5f);
+    Scene::StructureCache             structures{ *noiser, search_distance };
+    Scene::utils::DefferedExecutor    executor;
+    uint64_t                          frame = 0u;
+
+    vec2i ocean;
+    vec2i forest;
+    vec2i ridge;
+
+    World()
+    {
+        int32_t best_ocean = -1;
+        int32_t best_forest = -1;
+        int32_t best_ridge = -1;
+
+        Scene::utils::IterateFromMid(search_distance, { 0, 0 }, [&](int, const vec2i& pos) {
+            int32_t underwater = 0;
+            int32_t min_height = std::numeric_limits<int32_t>::max();
+            int32_t max_height = std::numeric_limits<int32_t>::min();
+            for (int32_t x = 0; x < Scene::g_chunk_size; x += sample_step)
+            {
+                for (int32_t z = 0; z < Scene::g_chunk_size; z += sample_step)
+                {
+                    auto height = noiser->GetHeight(pos.x * Scene::g_chunk_size + x, pos.y * Scene::g_chunk_size + z);
+                    underwater += height < static_cast<int32_t>(Scene::g_grass_bottom);
+                    min_height = std::min(min_height, height);
+                    max_height = std::max(max_height, height);
+                }
+            }
+
+            if (underwater > best_ocean)
+            {
+                best_ocean = underwater;
+                ocean = pos;
+            }
+            if (max_height - min_height > best_ridge)
+            {
+                best_ridge = max_height - min_height;
+                ridge = pos;
+            }
+            if (underwater == 0)
+            {
+                auto trees = static_cast<int32_t>(structures.Query(pos).size());
+                if (trees > best_forest)
+                {
+                    best_forest = trees;
+                    forest = pos;
+                }
+            }
+        });
+    }
+
+    const vec2i& Find(Landscape landscape) const
+    {
+        switch (landscape)
+        {
+        case Landscape::Ocean:  return ocean;
+        case Landscape::Forest: return forest;
+        case Landscape::Ridge:  return ridge;
+        }
+        throw std::invalid_argument("Unknown landscape");
+    }
+};
+
+World& GetWorld()
+{
+    static World world;
+    return world;
+}
+
+void ReportCounters(benchmark::State& state, const Scene::benchmarks::Allocations& before, uint32_t instances)
+{
+    auto after = Scene::benchmarks::Allocations::Get();
+    state.counters["instances"] = instances;
+    state.counters["allocs"] = benchmark::Counter(static_cast<double>(after.count - before.count), benchmark::Counter::kAvgIterations);
+    state.counters["bytes_allocated"] = benchmark::Counter(static_cast<double>(after.bytes - before.bytes), benchmark::Counter::kAvgIterations);
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Noise sampling, structure lookup, meshing and upload to the stub factory
+void BM_CreateChunk(benchmark::State& state, Landscape landscape)
+{
+    auto& world = GetWorld();
+    const auto& pos = world.Find(landscape);
+    auto lod = static_cast<uint32_t>(state.range(0));
+
+    uint32_t instances = 0u;
+    auto before = Scene::benchmarks::Allocations::Get();
+    for (auto _ : state)
+    {
+        Scene::Chunk chunk(pos, lod, *world.factory, *world.noiser, world.structures, world.executor, {});
+        world.executor.Execute(world.frame++);
+        instances = chunk.GetGpuSize() + chunk.GetWaterSize();
+    }
+    ReportCounters(state, before, instances);
+}
+
+// Meshing and upload only, the path taken by edits and lod changes
+void BM_RemeshChunk(benchmark::State& state, Landscape landscape)
+{
+    auto& world = GetWorld();
+    const auto& pos = world.Find(landscape);
+    auto lod = static_cast<uint32_t>(state.range(0));
+
+    Scene::ChunkTerrainPtr terrain;
+    {
+        Scene::Chunk chunk(pos, 0, *world.factory, *world.noiser, world.structures, world.executor, {});
+        terrain = chunk.GetTerrain();
+    }
+
+    uint32_t instances = 0u;
+    auto before = Scene::benchmarks::Allocations::Get();
+    for (auto _ : state)
+    {
+        Scene::Chunk chunk(pos, lod, terrain, *world.factory, world.executor, {});
+        world.executor.Execute(world.frame++);
+        instances = chunk.GetGpuSize() + chunk.GetWaterSize();
+    }
+    ReportCounters(state, before, instances);
+}
+
+}
+
+BENCHMARK_CAPTURE(BM_CreateChunk, ocean, Landscape::Ocean)->DenseRange(0, 2)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_CreateChunk, forest, Landscape::Forest)->DenseRange(0, 2)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_CreateChunk, ridge, Landscape::Ridge)->DenseRange(0, 2)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_CAPTURE(BM_RemeshChunk, ocean, Landscape::Ocean)->DenseRange(0, 2)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_RemeshChunk, forest, Landscape::Forest)->DenseRange(0, 2)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_RemeshChunk, ridge, Landscape::Ridge)->DenseRange(0, 2)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,116 @@
+#include <benchmark/benchmark.h>
+
+#include <IFactory.h>
+#include <ICamera.h>
+#include <IScene.h>
+
+#include <CameraTrack.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+
+#include "FrameStats.h"
+#include "Allocations.h"
+#include "StubLoader.h"
+
+namespace
+{
+
+constexpr double g_time_step = 1.0 / 60.0;
+
+// Straight flight above the terrain with a slow look around, one key per played frame
+Vulkan::CameraTrack CreateFlightTrack(int64_t frames)
+{
+    constexpr float speed = 2.f; // blocks per key
+    constexpr float height = 110.f;
+
+    Vulkan::CameraTrack res;
+    for (int64_t frame = 0; frame < frames; ++frame)
+    {
+        auto t = static_cast<float>(frame);
+        res.Add({ frame * g_time_step, { 100.f + speed * t, height, -100.f }, { -20.f, 180.f + 45.f * std::sin(t * 0.01f), 0.f } });
+    }
+    return res;
+}
+
+// A track recorded in the app with F9 replaces the scripted one when SCENE_CAMERA_TRACK names its file
+Vulkan::CameraTrack LoadTrack(int64_t frames)
+{
+    auto path = std::getenv("SCENE_CAMERA_TRACK");
+    if (!path)
+        return CreateFlightTrack(frames);
+
+    Vulkan::CameraTrack res;
+    if (!res.Load(path))
+        throw std::runtime_error(std::string("Failed to read the camera track ") + path);
+    return res;
+}
+
+constexpr size_t g_max_frames = 4096;
+
+// A fresh scene per iteration playing the whole track, percentiles cover the last g_max_frames frames
+void BM_Flight(benchmark::State& state)
+{
+    auto track = LoadTrack(state.range(0));
+    int64_t frames = 0;
+    std::array<Scene::utils::RollingPercentiles<g_max_frames>, static_cast<size_t>(Scene::FramePhase::Count)> phase_times;
+
+    Vulkan::RecordingStats recording;
+    int64_t frames_until_idle = -1;
+    uint64_t uploaded_at_start = 0u;
+    auto before = Scene::benchmarks::Allocations::Get();
+    for (auto _ : state)
+    {
+        auto camera = Vulkan::CreateCamera();
+        camera->SetPerspective(60.f, 16.f / 9.f, 0.1f, 2048.f);
+        Vulkan::CameraPlayer player(track, g_time_step);
+        player.Step(*camera);
+
+        auto scene = Scene::IScene::Create(*camera, CreateRecordingFactory(recording), std::make_unique<Scene::benchmarks::StubLoader>());
+        uploaded_at_start = recording.bytes_uploaded;
+        frames_until_idle = -1;
+        do
+        {
+            scene->Render();
+
+            const auto& stats = scene->GetStats();
+            for (size_t i = 0; i < phase_times.size(); ++i)
+                phase_times[i].Add(stats.phases[i].last);
+            if (frames_until_idle < 0 && stats.pending_chunks == 0 && stats.pending_gpu_tasks == 0)
+                frames_until_idle = static_cast<int64_t>(player.GetFrame()) - 1;
+        }
+        while (player.Step(*camera));
+        frames = static_cast<int64_t>(player.GetFrame());
+
+        state.PauseTiming();
+        scene.reset();
+        state.ResumeTiming();
+    }
+
+    auto after = Scene::benchmarks::Allocations::Get();
+    auto iterations = static_cast<double>(state.iterations());
+    auto total_frames = iterations * frames;
+
+    auto report_phase = [&](const char* name, Scene::FramePhase phase) {
+        auto [p50, p99] = phase_times[static_cast<size_t>(phase)].Get(std::array{ 50.0, 99.0 });
+        state.counters[std::string(name) + "_p50_us"] = static_cast<double>(p50);
+        state.counters[std::string(name) + "_p99_us"] = static_cast<double>(p99);
+    };
+    report_phase("frame", Scene::FramePhase::Frame);
+    report_phase("storage", Scene::FramePhase::StorageUpdate);
+    report_phase("drain", Scene::FramePhase::CompletionDrain);
+    report_phase("culling", Scene::FramePhase::Culling);
+    report_phase("recording", Scene::FramePhase::Recording);
+
+    state.counters["draws_per_frame"] = recording.draw_calls / total_frames;
+    state.counters["instances_per_frame"] = recording.instances_drawn / total_frames;
+    state.counters["uploaded_mb"] = (recording.bytes_uploaded - uploaded_at_start) / (1024.0 * 1024.0);
+    state.counters["frames_until_idle"] = static_cast<double>(frames_until_idle);
+    state.counters["allocs_per_frame"] = (after.count - before.count) / total_frames;
+    state.counters["alloc_mb"] = benchmark::Counter((after.bytes - before.bytes) / (1024.0 * 1024.0), benchmark::Counter::kAvgIterations);
+}
+
+}
+
+BENCHMARK(BM_Flight)->Arg(600)->Iterations(1)->Unit(benchmark::kMillisecond)->UseRealTime();
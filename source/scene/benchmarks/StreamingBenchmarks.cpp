@@ -0,0 +1,217 @@
+#include <benchmark/benchmark.h>
+
+#include <IFactory.h>
+#include <ICamera.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <thread>
+
+#include "ChunkStorage.h"
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+// Frames are paced like the app's vsync, so the workers get the same time per frame on every machine
+constexpr auto g_frame_time = std::chrono::microseconds(16667);
+constexpr uint64_t g_integration_budget_us = 4000u;
+constexpr int64_t g_max_frames = 60 * 60;
+
+constexpr float g_start_x = 100.f;
+constexpr float g_height = 110.f;
+constexpr float g_start_z = -100.f;
+
+// Chunk storage on the recording factory, render passes only keep the camera frustum current
+class StreamingWorld
+{
+public:
+    StreamingWorld()
+        : factory(CreateRecordingFactory(recording))
+        , camera(Vulkan::CreateCamera())
+    {
+        camera->SetPerspective(60.f, 16.f / 9.f, 0.1f, 2048.f);
+        camera->SetPosition(g_start_x, g_height, g_start_z);
+        camera->SetRotation(-20.f, 180.f, 0.f);
+        storage = Scene::IChunkStorage::Create(*camera, *factory);
+    }
+
+    ~StreamingWorld()
+    {
+        storage.reset();
+    }
+
+    Vulkan::ICamera& GetCamera()
+    {
+        return *camera;
+    }
+
+    const Scene::StorageStats& GetStats() const
+    {
+        return storage->GetStats();
+    }
+
+    // Integration time of the frame in microseconds
+    uint64_t Frame()
+    {
+        auto render_pass = factory->CreateRenderPass(*camera);
+        storage->OnRender();
+        storage->ForEachVisible([](const Scene::Chunk&) {});
+
+        const auto& stats = storage->GetStats();
+        next_frame = std::max(next_frame + g_frame_time, Clock::now());
+        std::this_thread::sleep_until(next_frame);
+        return stats.update_time + stats.drain_time;
+    }
+
+    bool Loaded() const
+    {
+        const auto& stats = storage->GetStats();
+        return stats.chunks_loaded == stats.chunks_in_range && stats.pending_remeshes == 0u;
+    }
+
+    void WaitLoaded()
+    {
+        for (int64_t i = 0; i < g_max_frames && !Loaded(); ++i)
+            Frame();
+    }
+
+private:
+    Vulkan::RecordingStats                 recording;
+    std::unique_ptr<Vulkan::IFactory>      factory;
+    std::unique_ptr<Vulkan::ICamera>       camera;
+    std::unique_ptr<Scene::IChunkStorage>  storage;
+    Clock::time_point                      next_frame = Clock::now();
+};
+
+// Loaded share of the render distance per frame, times to 50/90/100% count from the last Restart
+class LoadTracker
+{
+public:
+    explicit LoadTracker(const Scene::StorageStats& stats)
+        : built(stats.chunks_built)
+        , discarded(stats.chunks_discarded)
+    {
+    }
+
+    void OnFrame(const Scene::StorageStats& stats, uint64_t integration_time)
+    {
+        ++frames;
+        max_integration_time = std::max(max_integration_time, integration_time);
+        frames_over_budget += integration_time > g_integration_budget_us;
+
+        auto loaded = static_cast<double>(stats.chunks_loaded) / stats.chunks_in_range;
+        min_loaded = std::min(min_loaded, loaded);
+        auto ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        for (size_t i = 0; i < thresholds.size(); ++i)
+        {
+            if (time_to[i] < 0.0 && loaded >= thresholds[i])
+                time_to[i] = ms;
+        }
+        last_stats = stats;
+    }
+
+    void Restart()
+    {
+        start = Clock::now();
+        time_to = { -1.0, -1.0, -1.0 };
+    }
+
+    bool Done() const
+    {
+        return time_to.back() >= 0.0;
+    }
+
+    void Report(benchmark::State& state) const
+    {
+        state.counters["ms_to_50"] = time_to[0];
+        state.counters["ms_to_90"] = time_to[1];
+        state.counters["ms_to_100"] = time_to[2];
+        state.counters["frames"] = static_cast<double>(frames);
+        state.counters["min_loaded_pct"] = min_loaded * 100.0;
+        state.counters["max_integration_us"] = static_cast<double>(max_integration_time);
+        state.counters["frames_over_budget"] = static_cast<double>(frames_over_budget);
+        state.counters["chunks_built"] = static_cast<double>(last_stats.chunks_built - built);
+        state.counters["chunks_wasted"] = static_cast<double>(last_stats.chunks_discarded - discarded);
+    }
+
+private:
+    static constexpr std::array<double, 3> thresholds = { 0.5, 0.9, 1.0 };
+
+    Clock::time_point     start = Clock::now();
+    std::array<double, 3> time_to = { -1.0, -1.0, -1.0 };
+    uint64_t              built = 0u;
+    uint64_t              discarded = 0u;
+    Scene::StorageStats   last_stats;
+
+    int64_t  frames = 0;
+    double   min_loaded = 1.0;
+    uint64_t max_integration_time = 0u;
+    uint64_t frames_over_budget = 0u;
+};
+
+// Jump state.range(0) blocks along x from a fully loaded world
+void BM_Teleport(benchmark::State& state)
+{
+    auto distance = static_cast<float>(state.range(0));
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        StreamingWorld world;
+        world.WaitLoaded();
+        state.ResumeTiming();
+
+        LoadTracker tracker(world.GetStats());
+        world.GetCamera().SetPosition(g_start_x + distance, g_height, g_start_z);
+        for (int64_t i = 0; i < g_max_frames && !tracker.Done(); ++i)
+        {
+            auto integration_time = world.Frame();
+            tracker.OnFrame(world.GetStats(), integration_time);
+        }
+
+        state.PauseTiming();
+        tracker.Report(state);
+        state.ResumeTiming();
+    }
+}
+
+// Flight at state.range(0) blocks per frame for state.range(1) frames, then hover until the world catches up.
+// Times to 50/90/100% count from the stop.
+void BM_FlyAndStop(benchmark::State& state)
+{
+    auto speed = static_cast<float>(state.range(0));
+    auto flight_frames = state.range(1);
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        StreamingWorld world;
+        world.WaitLoaded();
+        state.ResumeTiming();
+
+        LoadTracker tracker(world.GetStats());
+        for (int64_t i = 1; i <= flight_frames; ++i)
+        {
+            world.GetCamera().SetPosition(g_start_x + speed * i, g_height, g_start_z);
+            auto integration_time = world.Frame();
+            tracker.OnFrame(world.GetStats(), integration_time);
+        }
+
+        tracker.Restart();
+        for (int64_t i = 0; i < g_max_frames && !tracker.Done(); ++i)
+        {
+            auto integration_time = world.Frame();
+            tracker.OnFrame(world.GetStats(), integration_time);
+        }
+
+        state.PauseTiming();
+        tracker.Report(state);
+        state.ResumeTiming();
+    }
+}
+
+}
+
+BENCHMARK(BM_Teleport)->Arg(256)->Arg(1024)->Iterations(1)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_FlyAndStop)->Args({ 1, 300 })->Args({ 4, 300 })->Args({ 16, 120 })->Iterations(1)->Unit(benchmark::kMillisecond)->UseRealTime();
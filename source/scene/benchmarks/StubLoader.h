@@ -0,0 +1,35 @@
+#pragma once
+
+#include <IResourceLoader.h>
+
+namespace Scene
+{
+namespace benchmarks
+{
+
+// Flat grey textures and empty shaders, the recording factory never looks at them
+struct StubLoader
+    : public IResourceLoader
+{
+    static constexpr uint32_t texture_size = 16u;
+
+    void LoadTexture(TextureType, uint32_t& w, uint32_t& h, std::vector<uint8_t>& storage) const override
+    {
+        w = texture_size;
+        h = texture_size;
+        storage.resize(storage.size() + texture_size * texture_size * 4u, 0x80);
+    }
+
+    std::unique_ptr<Vulkan::IDataProvider> LoadTextureArray(TextureType first, uint32_t count) const override
+    {
+        return DecodeTextureArray(first, count, *this);
+    }
+
+    std::vector<uint8_t> LoadShader(ShaderTarget, Vulkan::ShaderType) const override
+    {
+        return {};
+    }
+};
+
+}
+}
@@ -1,10 +1,13 @@
 #pragma once
 
+#include <cstdint>
+#include <memory>
 #include <vector>
 
 namespace Vulkan
 {
 enum class ShaderType;
+struct IDataProvider;
 }
 
 namespace Scene
@@ -39,9 +42,14 @@ enum class ShaderTarget : uint32_t
 struct IResourceLoader
 {
     virtual void LoadTexture(TextureType type, uint32_t& w, uint32_t& h, std::vector<uint8_t>& storage) const = 0;
+    // Layers from first on as one RGBA texture array, ready for the factory
+    virtual std::unique_ptr<Vulkan::IDataProvider> LoadTextureArray(TextureType first, uint32_t count) const = 0;
     virtual std::vector<uint8_t> LoadShader(ShaderTarget target, Vulkan::ShaderType type) const = 0;
 
     virtual ~IResourceLoader() = default;
 };
 
+// Decodes the layers with LoadTexture in parallel, for loaders that have nothing faster
+std::unique_ptr<Vulkan::IDataProvider> DecodeTextureArray(TextureType first, uint32_t count, const IResourceLoader& loader);
+
 }
@@ -3,6 +3,8 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <array>
+#include <cstdint>
 
 namespace Vulkan
 {
@@ -17,10 +19,52 @@ namespace Scene
 
 struct IResourceLoader;
 
+enum class FramePhase : uint32_t
+{
+    StorageUpdate = 0, // camera chunk tracking, scheduling and integrating loaded chunks
+    CompletionDrain,   // gpu uploads of finished chunks and remesh swaps
+    Culling,
+    Recording,
+    Submit,
+    Frame,             // the whole Render call
+    Count,
+};
+
+// Microseconds, percentiles over the last SceneStats::window frames
+struct PhaseTiming
+{
+    uint64_t last = 0u;
+    uint64_t p50 = 0u;
+    uint64_t p95 = 0u;
+    uint64_t p99 = 0u;
+};
+
+struct SceneStats
+{
+    static constexpr uint32_t window = 512u;
+
+    uint64_t frame = 0u;
+    std::array<PhaseTiming, static_cast<size_t>(FramePhase::Count)> phases{};
+
+    uint32_t chunks_loaded = 0u;
+    uint32_t chunks_visible = 0u; // passed frustum and horizon culling
+    uint32_t chunks_drawn = 0u;   // passed occlusion culling too
+    uint64_t instances = 0u;
+
+    uint32_t uploads = 0u;          // gpu tasks run this frame, chunk uploads
+    uint32_t pending_chunks = 0u;
+    uint32_t pending_remeshes = 0u;
+    uint32_t pending_gpu_tasks = 0u;
+
+    const PhaseTiming& Get(FramePhase phase) const { return phases[static_cast<size_t>(phase)]; }
+};
+
 struct IScene
 {
     virtual void Render() = 0;
     virtual const std::string& GetInfo() const = 0;
+    // Percentiles are refreshed every few frames, the rest describes the last frame
+    virtual const SceneStats& GetStats() const = 0;
 
     virtual ~IScene() = default;
 
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Scene
+{
+
+// Mip chains of RGBA8 texture arrays with alpha premultiplied, the layout the loaders decode to.
+// Levels are stored level major: every layer of level 0, then every layer of level 1 and so on
+// down to 1x1, so one copy region per level uploads the whole array.
+
+// Full chain down to 1x1
+uint32_t GetMipLevels(uint32_t width, uint32_t height);
+
+// Bytes of depth layers with all their levels
+uint64_t GetMipChainSize(uint32_t width, uint32_t height, uint32_t depth);
+
+// Appends the smaller levels to base, which holds level 0 of every layer. Texels are filtered
+// in linear color and weighted by their alpha, so transparent texels never darken the edges of leaves
+std::vector<uint8_t> BuildMipChain(std::span<const uint8_t> base, uint32_t width, uint32_t height, uint32_t depth);
+
+}
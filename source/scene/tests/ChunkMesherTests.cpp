@@ -0,0 +1,223 @@
+#include "gtest/gtest.h"
+
+#include "ChunkMesher.h"
+#include "Structures.h"
+#include "IResourceLoader.h"
+
+#include <algorithm>
+#include <cstring>
+
+using Scene::utils::vec2i;
+
+static Scene::ChunkTerrain CreateFlatTerrain(int32_t height)
+{
+    Scene::ChunkTerrain terrain;
+    terrain.heights.assign((Scene::g_chunk_size + 2) * (Scene::g_chunk_size + 2), height);
+    return terrain;
+}
+
+static std::vector<Scene::CubeInstance> Write(const Scene::ChunkMesher& mesher)
+{
+    const auto& size = mesher.GetSize();
+    std::vector<Scene::CubeInstance> res(size.cubes + size.water);
+    std::span<Scene::CubeInstance> all(res);
+    mesher.Write(all.first(size.cubes), all.last(size.water));
+    return res;
+}
+
+static uint32_t GetFace(const Scene::CubeInstance& cube)
+{
+    return cube.face & 0xFF;
+}
+
+static uint32_t GetSizeX(const Scene::CubeInstance& cube)
+{
+    return ((cube.face >> 8) & 0xFF) + 1;
+}
+
+static uint32_t GetSizeZ(const Scene::CubeInstance& cube)
+{
+    return ((cube.face >> 24) & 0xFF) + 1;
+}
+
+TEST(ChunkMesherTests, FlatTerrain)
+{
+    auto terrain = CreateFlatTerrain(64);
+    Scene::ChunkMesher mesher({ 1, -2 }, 0, terrain, {});
+
+    EXPECT_EQ(mesher.GetSize().cubes, static_cast<uint32_t>(Scene::g_chunk_size * Scene::g_chunk_size));
+    EXPECT_EQ(mesher.GetSize().water, 0u);
+    EXPECT_EQ(mesher.GetBBox().first.y, 64);
+    EXPECT_EQ(mesher.GetBBox().second.y, 65);
+    EXPECT_EQ(mesher.GetBBox().first.x, Scene::g_chunk_size);
+    EXPECT_EQ(mesher.GetBBox().first.z, -2 * Scene::g_chunk_size);
+
+    for (const auto& cube : Write(mesher))
+    {
+        EXPECT_EQ(GetFace(cube), static_cast<uint32_t>(Scene::CubeFace::top));
+        EXPECT_EQ(cube.pos[1], 64.f);
+    }
+}
+
+TEST(ChunkMesherTests, WaterIsMerged)
+{
+    auto terrain = CreateFlatTerrain(40);
+    Scene::ChunkMesher mesher({ 0, 0 }, 0, terrain, {});
+
+    ASSERT_EQ(mesher.GetSize().water, 1u);
+    auto water = Write(mesher).back();
+    EXPECT_EQ(water.texture, static_cast<uint32_t>(Scene::TextureType::WaterOverlay));
+    EXPECT_EQ(GetSizeX(water), static_cast<uint32_t>(Scene::g_chunk_size));
+    EXPECT_EQ(GetSizeZ(water), static_cast<uint32_t>(Scene::g_chunk_size));
+}
+
+TEST(ChunkMesherTests, WaterCoversUnderwaterColumns)
+{
+    auto terrain = CreateFlatTerrain(40);
+    for (int32_t x = 10; x < 20; ++x)
+        for (int32_t z = 0; z < 5; ++z)
+            terrain.heights[(x + 1) * (Scene::g_chunk_size + 2) + z + 1] = 70;
+
+    Scene::ChunkMesher mesher({ 0, 0 }, 0, terrain, {});
+    auto instances = Write(mesher);
+
+    uint32_t covered = 0;
+    for (size_t i = mesher.GetSize().cubes; i < instances.size(); ++i)
+        covered += GetSizeX(instances[i]) * GetSizeZ(instances[i]);
+    EXPECT_EQ(covered, static_cast<uint32_t>(Scene::g_chunk_size * Scene::g_chunk_size - 10 * 5));
+    EXPECT_LE(mesher.GetSize().water, 3u);
+}
+
+TEST(ChunkMesherTests, Downsampled)
+{
+    auto terrain = CreateFlatTerrain(64);
+    for (uint32_t lod = 1; lod < 3; ++lod)
+    {
+        Scene::ChunkMesher mesher({ 0, 0 }, lod, terrain, {});
+        auto cells = static_cast<uint32_t>(Scene::g_chunk_size >> lod);
+        EXPECT_EQ(mesher.GetSize().cubes, cells * cells);
+
+        for (const auto& cube : Write(mesher))
+        {
+            EXPECT_EQ(GetSizeX(cube), 1u << lod);
+            EXPECT_EQ(cube.pos[1] + (1u << lod), 65.f);
+        }
+    }
+}
+
+TEST(ChunkMesherTests, RemovedBlock)
+{
+    auto terrain = CreateFlatTerrain(64);
+    Scene::BlockEdits edits;
+    edits[{ 5, 64, 7 }] = std::nullopt;
+
+    Scene::ChunkMesher mesher({ 0, 0 }, 0, terrain, edits);
+    // The hole shows its floor and one wall of every neighbour
+    EXPECT_EQ(mesher.GetSize().cubes, static_cast<uint32_t>(Scene::g_chunk_size * Scene::g_chunk_size + 4));
+}
+
+TEST(ChunkMesherTests, PlacedBlock)
+{
+    auto terrain = CreateFlatTerrain(64);
+    Scene::BlockEdits edits;
+    edits[{ 5, 65, 7 }] = Scene::TextureType::Stone;
+
+    Scene::ChunkMesher mesher({ 0, 0 }, 0, terrain, edits);
+    // The block hides the top below it and shows its own top and walls
+    EXPECT_EQ(mesher.GetSize().cubes, static_cast<uint32_t>(Scene::g_chunk_size * Scene::g_chunk_size + 4));
+
+    uint32_t block_faces = 0;
+    for (const auto& cube : Write(mesher))
+    {
+        if (cube.pos[0] == 5.f && cube.pos[1] == 65.f && cube.pos[2] == 7.f)
+        {
+            EXPECT_EQ(cube.texture, static_cast<uint32_t>(Scene::TextureType::Stone));
+            ++block_faces;
+        }
+        EXPECT_FALSE(cube.pos[0] == 5.f && cube.pos[1] == 64.f && cube.pos[2] == 7.f);
+    }
+    EXPECT_EQ(block_faces, 5u);
+}
+
+TEST(ChunkMesherTests, EditInNeighbourChunk)
+{
+    auto terrain = CreateFlatTerrain(64);
+    Scene::BlockEdits edits;
+    edits[{ -1, 64, 7 }] = std::nullopt;
+
+    // Only the wall facing the hole belongs to this chunk
+    Scene::ChunkMesher mesher({ 0, 0 }, 0, terrain, edits);
+    EXPECT_EQ(mesher.GetSize().cubes, static_cast<uint32_t>(Scene::g_chunk_size * Scene::g_chunk_size + 1));
+
+    auto cubes = Write(mesher);
+    auto wall = std::find_if(cubes.begin(), cubes.end(), [](const Scene::CubeInstance& cube) {
+        return GetFace(cube) == static_cast<uint32_t>(Scene::CubeFace::left);
+    });
+    ASSERT_NE(wall, cubes.end());
+    EXPECT_EQ(wall->pos[0], 0.f);
+    EXPECT_EQ(wall->pos[1], 64.f);
+    EXPECT_EQ(wall->pos[2], 7.f);
+}
+
+TEST(ChunkMesherTests, EditsReplaceTrees)
+{
+    auto terrain = CreateFlatTerrain(64);
+    terrain.structures.push_back({ Scene::StructureType::Tree, { 8, 65, 8 }, { { 6, 65, 6 }, { 11, 71, 11 } } });
+    auto tree_faces = Scene::ChunkMesher({ 0, 0 }, 0, terrain, {}).GetSize().cubes;
+
+    Scene::BlockEdits edits;
+    edits[{ 8, 65, 8 }] = std::nullopt;
+    edits[{ 8, 66, 8 }] = Scene::TextureType::Stone;
+    Scene::ChunkMesher mesher({ 0, 0 }, 0, terrain, edits);
+
+    uint32_t log_faces = 0;
+    for (const auto& cube : Write(mesher))
+    {
+        if (cube.pos[0] != 8.f || cube.pos[2] != 8.f)
+            continue;
+        if (cube.pos[1] == 65.f)
+            ++log_faces;
+        if (cube.pos[1] == 66.f)
+            EXPECT_EQ(cube.texture, static_cast<uint32_t>(Scene::TextureType::Stone));
+    }
+    // The removed log leaves nothing, the stone replacing the log above it floats and shows every face
+    EXPECT_EQ(log_faces, 0u);
+    EXPECT_EQ(mesher.GetSize().cubes, tree_faces - 8u + 6u);
+}
+
+TEST(ChunkMesherTests, WrongOutputSize)
+{
+    auto terrain = CreateFlatTerrain(64);
+    Scene::ChunkMesher mesher({ 0, 0 }, 0, terrain, {});
+
+    std::vector<Scene::CubeInstance> out(mesher.GetSize().cubes - 1);
+    EXPECT_THROW(mesher.Write(out, {}), std::invalid_argument);
+}
+
+TEST(ChunkMesherTests, PassesDisagree)
+{
+    auto terrain = CreateFlatTerrain(64);
+    Scene::BlockEdits edits;
+    Scene::ChunkMesher mesher({ 0, 0 }, 0, terrain, edits);
+
+    // The hole adds faces the counting pass never saw, none may be written past the output
+    edits[{ 5, 64, 7 }] = std::nullopt;
+    std::vector<Scene::CubeInstance> out(mesher.GetSize().cubes + 1);
+    std::span<Scene::CubeInstance> cubes(out);
+    EXPECT_THROW(mesher.Write(cubes.first(mesher.GetSize().cubes), {}), std::logic_error);
+    EXPECT_EQ(out.back().face, 0u);
+    EXPECT_EQ(out.back().texture, 0u);
+}
+
+TEST(ChunkMesherTests, Deterministic)
+{
+    auto terrain = CreateFlatTerrain(64);
+    for (int32_t i = 0; i < static_cast<int32_t>(terrain.heights.size()); ++i)
+        terrain.heights[i] = 50 + (i * 7919) % 31;
+
+    Scene::ChunkMesher mesher({ 3, 3 }, 0, terrain, {});
+    auto first = Write(mesher);
+    auto second = Write(mesher);
+    ASSERT_EQ(first.size(), second.size());
+    EXPECT_EQ(std::memcmp(first.data(), second.data(), first.size() * sizeof(Scene::CubeInstance)), 0);
+}
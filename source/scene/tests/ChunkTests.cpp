@@ -0,0 +1,109 @@
+#include "gtest/gtest.h"
+
+#include <IFactory.h>
+#include <ICamera.h>
+
+#include "Chunk.h"
+#include "ChunkMesher.h"
+#include "Structures.h"
+#include "ThreadUtils.hpp"
+
+static Scene::ChunkTerrainPtr CreateFlatTerrain(int32_t height)
+{
+    auto terrain = std::make_shared<Scene::ChunkTerrain>();
+    terrain->heights.assign((Scene::g_chunk_size + 2) * (Scene::g_chunk_size + 2), height);
+    return terrain;
+}
+
+class ChunkTests
+    : public ::testing::Test
+{
+protected:
+    Vulkan::RecordingStats            stats;
+    std::unique_ptr<Vulkan::IFactory> factory = CreateRecordingFactory(stats);
+    std::unique_ptr<Vulkan::ICamera>  camera = Vulkan::CreateCamera();
+    Vulkan::ICommandBuffer&           command_buffer = factory->AddCommandBuffer(*camera);
+    Scene::utils::DefferedExecutor    pool;
+};
+
+TEST_F(ChunkTests, DrawsItsInstances)
+{
+    Scene::Chunk chunk({ 0, 0 }, 0, CreateFlatTerrain(64), *factory, pool, {});
+    EXPECT_FALSE(chunk.Ready());
+    pool.Execute(1u);
+    ASSERT_TRUE(chunk.Ready());
+
+    chunk.Draw(command_buffer);
+    chunk.DrawWater(command_buffer);
+    EXPECT_EQ(stats.draw_calls, 1u);
+    EXPECT_EQ(stats.instances_drawn, static_cast<uint64_t>(Scene::g_chunk_size * Scene::g_chunk_size));
+}
+
+TEST_F(ChunkTests, AllAirChunkDrawsNothing)
+{
+    // Every block removed down to the bottom of the world, high enough to have no water
+    Scene::BlockEdits edits;
+    for (int32_t x = 0; x < Scene::g_chunk_size; ++x)
+        for (int32_t z = 0; z < Scene::g_chunk_size; ++z)
+            for (int32_t y = 0; y <= static_cast<int32_t>(Scene::g_grass_bottom); ++y)
+                edits[{ x, y, z }] = std::nullopt;
+
+    Scene::Chunk chunk({ 0, 0 }, 0, CreateFlatTerrain(Scene::g_grass_bottom), *factory, pool, edits);
+    pool.Execute(1u);
+    ASSERT_TRUE(chunk.Ready());
+    EXPECT_FALSE(chunk.HasCubes());
+    EXPECT_FALSE(chunk.HasWater());
+    EXPECT_EQ(stats.buffers_created, 0u);
+
+    chunk.Draw(command_buffer);
+    chunk.DrawWater(command_buffer);
+    EXPECT_EQ(stats.draw_calls, 0u);
+    EXPECT_EQ(stats.instances_drawn, 0u);
+}
+
+TEST_F(ChunkTests, EditPatchesTheBufferOfTheChunkItReplaces)
+{
+    Scene::BlockEdits edits = { { { 4, 64, 4 }, std::nullopt } };
+    Scene::Chunk previous({ 0, 0 }, 0, CreateFlatTerrain(64), *factory, pool, edits);
+    pool.Execute(1u);
+    ASSERT_TRUE(previous.Ready());
+    auto buffers_created = stats.buffers_created.load();
+    auto bytes_uploaded = stats.bytes_uploaded.load();
+
+    edits[{ 20, 64, 20 }] = std::nullopt;
+    Scene::Chunk chunk({ 0, 0 }, 0, previous.GetTerrain(), *factory, pool, edits);
+    ASSERT_TRUE(chunk.Patch(previous));
+    EXPECT_TRUE(chunk.Ready());
+    EXPECT_EQ(pool.Execute(2u), 0u);
+
+    // One buffer update of the changed cubes rather than a new buffer
+    EXPECT_EQ(stats.buffers_created, buffers_created);
+    EXPECT_EQ(stats.buffer_updates, 1u);
+    EXPECT_GT(stats.bytes_uploaded, bytes_uploaded);
+    EXPECT_LT(stats.bytes_uploaded - bytes_uploaded, chunk.GetGpuSize() * sizeof(Scene::CubeInstance));
+
+    previous.Draw(command_buffer);
+    EXPECT_EQ(stats.draw_calls, 0u);
+    chunk.Draw(command_buffer);
+    EXPECT_EQ(stats.draw_calls, 1u);
+    EXPECT_EQ(stats.instances_drawn, chunk.GetGpuSize());
+}
+
+TEST_F(ChunkTests, ChunkWithoutEditsIsNotPatched)
+{
+    Scene::Chunk previous({ 0, 0 }, 0, CreateFlatTerrain(64), *factory, pool, {});
+    pool.Execute(1u);
+
+    Scene::BlockEdits edits = { { { 4, 64, 4 }, std::nullopt } };
+    Scene::Chunk chunk({ 0, 0 }, 0, previous.GetTerrain(), *factory, pool, edits);
+    EXPECT_FALSE(chunk.Patch(previous));
+    EXPECT_FALSE(chunk.Ready());
+    pool.Execute(2u);
+    EXPECT_TRUE(chunk.Ready());
+    EXPECT_EQ(stats.buffer_updates, 0u);
+
+    // Committed already, the next edit can't patch it either
+    Scene::Chunk next({ 0, 0 }, 0, previous.GetTerrain(), *factory, pool, edits);
+    pool.Execute(3u);
+    EXPECT_FALSE(next.Patch(chunk));
+}
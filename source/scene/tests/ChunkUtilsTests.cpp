@@ -72,6 +72,24 @@ TEST(ChunkUtilsTests, get_rank_test)
             );
 }
 
+TEST(ChunkUtilsTests, get_lod_test)
+{
+    vec2i cam(-10, 10);
+    EXPECT_EQ(Scene::utils::GetLod(cam, cam), 0u);
+    EXPECT_EQ(Scene::utils::GetLod(cam, cam + vec2i(-5, 5)), 0u);
+    EXPECT_EQ(Scene::utils::GetLod(cam, cam + vec2i(6, 0)), 1u);
+    EXPECT_EQ(Scene::utils::GetLod(cam, cam + vec2i(3, -10)), 1u);
+    EXPECT_EQ(Scene::utils::GetLod(cam, cam + vec2i(11, 11)), 2u);
+    EXPECT_EQ(Scene::utils::GetLod(cam, cam + vec2i(0, -render_distance)), 2u);
+
+    for (int32_t i = -render_distance; i < render_distance; ++i)
+        for (int32_t j = -render_distance; j < render_distance; ++j)
+            ASSERT_GE(
+                Scene::utils::GetLod(cam, cam + vec2i(i, j)),
+                Scene::utils::GetLod(cam, cam + vec2i(i / 2, j / 2))
+            );
+}
+
 TEST(ChunkUtilsTests, ShiftTest1)
 {
     std::vector<std::vector<int>> before = {
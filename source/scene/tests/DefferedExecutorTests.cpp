@@ -0,0 +1,104 @@
+#include "gtest/gtest.h"
+
+#include "ThreadUtils.hpp"
+
+#include <vector>
+
+using Scene::utils::DefferedExecutor;
+
+TEST(DefferedExecutorTests, RunsAfterDelay)
+{
+    DefferedExecutor executor;
+    std::vector<int> order;
+    executor.Add(DefferedExecutor::immediate, [&] { order.push_back(0); });
+    executor.Add(2u, [&] { order.push_back(2); });
+    executor.Add(1u, [&] { order.push_back(1); });
+    EXPECT_EQ(executor.Size(), 3u);
+
+    EXPECT_EQ(executor.Execute(0u), 1u);
+    EXPECT_EQ(executor.Execute(1u), 1u);
+    EXPECT_EQ(executor.Execute(2u), 1u);
+    EXPECT_EQ(order, std::vector<int>({ 0, 1, 2 }));
+    EXPECT_EQ(executor.Size(), 0u);
+}
+
+TEST(DefferedExecutorTests, SubmissionOrderWithinFrame)
+{
+    DefferedExecutor executor;
+    std::vector<int> order;
+    for (int i = 0; i < 10; ++i)
+        executor.Add(DefferedExecutor::immediate, [&order, i] { order.push_back(i); });
+
+    EXPECT_EQ(executor.Execute(0u), 10u);
+    EXPECT_EQ(order, std::vector<int>({ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 }));
+}
+
+TEST(DefferedExecutorTests, LongDelaysAndSkippedFrames)
+{
+    DefferedExecutor executor;
+    int runs = 0;
+    executor.Add(DefferedExecutor::wheel_size * 3u, [&] { ++runs; });
+    executor.Add(5u, [&] { ++runs; });
+
+    EXPECT_EQ(executor.Execute(4u), 0u);
+    EXPECT_EQ(executor.Execute(100u), 1u);
+    EXPECT_EQ(executor.Execute(DefferedExecutor::wheel_size * 3u - 1u), 0u);
+    EXPECT_EQ(executor.Execute(DefferedExecutor::wheel_size * 3u), 1u);
+    EXPECT_EQ(runs, 2);
+}
+
+TEST(DefferedExecutorTests, RemovedTaskNeverRuns)
+{
+    DefferedExecutor executor;
+    bool ran = false;
+    auto captured = std::make_shared<int>(0);
+    auto handle = executor.Add(1u, [&ran, captured] { ran = true; });
+    executor.Remove(handle);
+
+    // The captures are released by Remove already
+    EXPECT_EQ(captured.use_count(), 1);
+    EXPECT_EQ(executor.Size(), 0u);
+    EXPECT_EQ(executor.Execute(10u), 0u);
+    EXPECT_FALSE(ran);
+
+    // Removing a finished task does nothing
+    auto done = executor.Add(DefferedExecutor::immediate, [&ran] { ran = true; });
+    executor.Execute(10u);
+    executor.Remove(done);
+    EXPECT_TRUE(ran);
+}
+
+TEST(DefferedExecutorTests, ConcurrentProducers)
+{
+    constexpr int threads_count = 4;
+    constexpr int tasks_per_thread = 10000;
+
+    DefferedExecutor executor;
+    std::atomic<int> runs = 0;
+    std::atomic<int> finished = 0;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threads_count; ++t)
+    {
+        threads.emplace_back([&] {
+            for (int i = 0; i < tasks_per_thread; ++i)
+            {
+                auto handle = executor.Add(i % 3, [&] { ++runs; });
+                if (i % 2)
+                    executor.Remove(handle);
+            }
+            ++finished;
+        });
+    }
+
+    uint64_t frame = 0u;
+    while (finished < threads_count)
+        executor.Execute(frame++);
+    for (auto& thread : threads)
+        thread.join();
+    executor.Execute(frame + 3u);
+
+    // Removes racing with Execute may come too late, but every task either ran or was removed
+    EXPECT_GE(runs, threads_count * tasks_per_thread / 2);
+    EXPECT_LE(runs, threads_count * tasks_per_thread);
+    EXPECT_EQ(executor.Size(), 0u);
+}
@@ -0,0 +1,52 @@
+#include "gtest/gtest.h"
+
+#include "FrameStats.h"
+
+using Scene::utils::RollingPercentiles;
+
+TEST(FrameStatsTests, Empty)
+{
+    RollingPercentiles<16> samples;
+    auto res = samples.Get(std::array{ 50.0, 99.0 });
+    EXPECT_EQ(res[0], 0u);
+    EXPECT_EQ(res[1], 0u);
+}
+
+TEST(FrameStatsTests, Percentiles)
+{
+    RollingPercentiles<100> samples;
+    for (uint64_t i = 100; i > 0; --i)
+        samples.Add(i);
+
+    auto [p0, p50, p95, p99, p100] = samples.Get(std::array{ 0.0, 50.0, 95.0, 99.0, 100.0 });
+    EXPECT_EQ(p0, 1u);
+    EXPECT_EQ(p50, 51u);
+    EXPECT_EQ(p95, 95u);
+    EXPECT_EQ(p99, 99u);
+    EXPECT_EQ(p100, 100u);
+}
+
+TEST(FrameStatsTests, PartialWindow)
+{
+    RollingPercentiles<64> samples;
+    samples.Add(10);
+    samples.Add(30);
+    samples.Add(20);
+
+    auto [p0, p50, p100] = samples.Get(std::array{ 0.0, 50.0, 100.0 });
+    EXPECT_EQ(p0, 10u);
+    EXPECT_EQ(p50, 20u);
+    EXPECT_EQ(p100, 30u);
+}
+
+TEST(FrameStatsTests, OldSamplesDropped)
+{
+    RollingPercentiles<8> samples;
+    for (uint64_t i = 0; i < 8; ++i)
+        samples.Add(1000);
+    for (uint64_t i = 0; i < 8; ++i)
+        samples.Add(i);
+
+    auto [p100] = samples.Get(std::array{ 100.0 });
+    EXPECT_EQ(p100, 7u);
+}
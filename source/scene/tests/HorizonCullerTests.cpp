@@ -0,0 +1,64 @@
+#include "gtest/gtest.h"
+
+#include "HorizonCuller.h"
+
+using Scene::Point3D;
+
+static std::pair<Point3D, Point3D> ChunkBox(int32_t x, int32_t z, int32_t bottom, int32_t top)
+{
+    return { { x * Scene::g_chunk_size, bottom, z * Scene::g_chunk_size }, { (x + 1) * Scene::g_chunk_size, top, (z + 1) * Scene::g_chunk_size } };
+}
+
+class HorizonCullerTests : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        culler.Begin({ 16.f, 70.f, 16.f });
+    }
+
+    Scene::HorizonCuller culler;
+};
+
+TEST_F(HorizonCullerTests, NothingAdded)
+{
+    EXPECT_TRUE(culler.IsVisible(ChunkBox(5, 0, 10, 11)));
+    EXPECT_TRUE(culler.IsVisible(ChunkBox(-5, -5, 10, 11)));
+}
+
+TEST_F(HorizonCullerTests, RidgeHidesValley)
+{
+    for (int32_t z = -3; z <= 3; ++z)
+        culler.AddOccluder(ChunkBox(2, z, 100, 110));
+
+    EXPECT_FALSE(culler.IsVisible(ChunkBox(5, 0, 40, 60)));
+    // Above the ridge, beside it and behind the eye
+    EXPECT_TRUE(culler.IsVisible(ChunkBox(5, 0, 40, 200)));
+    EXPECT_TRUE(culler.IsVisible(ChunkBox(0, 5, 40, 60)));
+    EXPECT_TRUE(culler.IsVisible(ChunkBox(-5, 0, 40, 60)));
+}
+
+TEST_F(HorizonCullerTests, GroundBelowEye)
+{
+    // Terrain under the eye only hides what is lower still
+    for (int32_t z = -3; z <= 3; ++z)
+        culler.AddOccluder(ChunkBox(1, z, 60, 65));
+
+    EXPECT_FALSE(culler.IsVisible(ChunkBox(2, 0, 0, 10)));
+    EXPECT_TRUE(culler.IsVisible(ChunkBox(2, 0, 20, 40)));
+}
+
+TEST_F(HorizonCullerTests, EyeChunkNeverOccludes)
+{
+    culler.AddOccluder(ChunkBox(0, 0, 200, 210));
+    EXPECT_TRUE(culler.IsVisible(ChunkBox(3, 0, 10, 11)));
+    EXPECT_TRUE(culler.IsVisible(ChunkBox(0, 0, 10, 11)));
+}
+
+TEST_F(HorizonCullerTests, PartialBucketsDontOcclude)
+{
+    // A single chunk covers only part of the view of a wide box behind it
+    culler.AddOccluder(ChunkBox(2, 0, 100, 110));
+    EXPECT_TRUE(culler.IsVisible({ { 5 * Scene::g_chunk_size, 40, -4 * Scene::g_chunk_size }, { 6 * Scene::g_chunk_size, 60, 5 * Scene::g_chunk_size } }));
+    EXPECT_FALSE(culler.IsVisible({ { 5 * Scene::g_chunk_size, 40, 14 }, { 5 * Scene::g_chunk_size + 4, 60, 18 } }));
+}
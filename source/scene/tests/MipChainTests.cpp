@@ -0,0 +1,95 @@
+#include "gtest/gtest.h"
+
+#include "MipChain.h"
+
+#include <array>
+
+using Rgba = std::array<uint8_t, 4>;
+
+static std::vector<uint8_t> CreateLayer(uint32_t width, uint32_t height, const Rgba& even, const Rgba& odd)
+{
+    std::vector<uint8_t> res;
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            const auto& color = (x + y) % 2 ? odd : even;
+            res.insert(res.end(), color.begin(), color.end());
+        }
+    }
+    return res;
+}
+
+static Rgba GetTexel(const std::vector<uint8_t>& chain, size_t offset)
+{
+    return { chain[offset], chain[offset + 1], chain[offset + 2], chain[offset + 3] };
+}
+
+TEST(MipChainTests, Levels)
+{
+    EXPECT_EQ(Scene::GetMipLevels(1, 1), 1u);
+    EXPECT_EQ(Scene::GetMipLevels(16, 16), 5u);
+    EXPECT_EQ(Scene::GetMipLevels(16, 4), 5u);
+    EXPECT_EQ(Scene::GetMipLevels(3, 5), 3u);
+
+    // 16x16, 8x8, 4x4, 2x2, 1x1
+    EXPECT_EQ(Scene::GetMipChainSize(16, 16, 2), (256u + 64u + 16u + 4u + 1u) * 4u * 2u);
+    // 4x1, 2x1, 1x1
+    EXPECT_EQ(Scene::GetMipChainSize(4, 1, 1), (4u + 2u + 1u) * 4u);
+}
+
+TEST(MipChainTests, SolidColorKeepsItsValue)
+{
+    Rgba color = { 200, 100, 50, 255 };
+    auto chain = Scene::BuildMipChain(CreateLayer(8, 8, color, color), 8, 8, 1);
+    ASSERT_EQ(chain.size(), Scene::GetMipChainSize(8, 8, 1));
+    for (size_t offset = 0; offset < chain.size(); offset += 4)
+        EXPECT_EQ(GetTexel(chain, offset), color);
+}
+
+TEST(MipChainTests, FilteredInLinearColor)
+{
+    auto chain = Scene::BuildMipChain(CreateLayer(2, 2, { 0, 0, 0, 255 }, { 255, 255, 255, 255 }), 2, 2, 1);
+    // Half of the light in sRGB, a plain average of the bytes would give 128
+    EXPECT_EQ(GetTexel(chain, 16u), (Rgba{ 188, 188, 188, 255 }));
+}
+
+TEST(MipChainTests, TransparentTexelsDoNotDarken)
+{
+    auto chain = Scene::BuildMipChain(CreateLayer(2, 2, { 0, 0, 0, 0 }, { 60, 200, 40, 255 }), 2, 2, 1);
+    // Half covered with the color of the opaque texels, premultiplied by that coverage
+    auto texel = GetTexel(chain, 16u);
+    EXPECT_EQ(texel[3], 128u);
+    EXPECT_NEAR(texel[0], 30, 1);
+    EXPECT_NEAR(texel[1], 100, 1);
+    EXPECT_NEAR(texel[2], 20, 1);
+}
+
+TEST(MipChainTests, LevelMajorLayout)
+{
+    Rgba red = { 255, 0, 0, 255 };
+    Rgba blue = { 0, 0, 255, 255 };
+    auto base = CreateLayer(4, 2, red, red);
+    auto second = CreateLayer(4, 2, blue, blue);
+    base.insert(base.end(), second.begin(), second.end());
+
+    auto chain = Scene::BuildMipChain(base, 4, 2, 2);
+    ASSERT_EQ(chain.size(), (8u + 2u + 1u) * 4u * 2u);
+
+    // Level 1 is 2x1 per layer, right after both layers of level 0
+    size_t level1 = 8u * 4u * 2u;
+    EXPECT_EQ(GetTexel(chain, level1), red);
+    EXPECT_EQ(GetTexel(chain, level1 + 4u), red);
+    EXPECT_EQ(GetTexel(chain, level1 + 8u), blue);
+    EXPECT_EQ(GetTexel(chain, level1 + 12u), blue);
+
+    size_t level2 = level1 + 2u * 4u * 2u;
+    EXPECT_EQ(GetTexel(chain, level2), red);
+    EXPECT_EQ(GetTexel(chain, level2 + 4u), blue);
+}
+
+TEST(MipChainTests, BaseSizeMismatch)
+{
+    std::vector<uint8_t> base(4u * 4u * 4u);
+    EXPECT_THROW(Scene::BuildMipChain(base, 4, 4, 2), std::logic_error);
+}
@@ -0,0 +1,108 @@
+#include "gtest/gtest.h"
+
+#include "OcclusionCuller.h"
+
+#include <cmath>
+
+// Camera at (0, eye_y, 0) looking along +z, column major like the renderer's matrices
+static std::array<float, 16> CreateViewProjection(float fov_y, float aspect, float near_plane, float far_plane, float eye_y = 0.f)
+{
+    float f = 1.f / std::tan(fov_y / 2.f);
+    std::array<float, 16> res{};
+    res[0] = f / aspect;
+    res[5] = f;
+    res[10] = (far_plane + near_plane) / (far_plane - near_plane);
+    res[11] = 1.f;
+    res[13] = -eye_y * f;
+    res[14] = -2.f * far_plane * near_plane / (far_plane - near_plane);
+    return res;
+}
+
+class OcclusionCullerTests : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        culler.Begin(CreateViewProjection(1.2f, 2.f, 0.1f, 1000.f), {});
+    }
+
+    Scene::OcclusionCuller culler;
+};
+
+TEST_F(OcclusionCullerTests, EmptyBuffer)
+{
+    culler.Finish();
+    EXPECT_TRUE(culler.IsVisible({ -1.f, -1.f, 10.f, 1.f, 1.f, 12.f }));
+    EXPECT_TRUE(culler.IsVisible({ -1.f, -1.f, 500.f, 1.f, 1.f, 502.f }));
+}
+
+TEST_F(OcclusionCullerTests, WallHidesBoxBehind)
+{
+    culler.AddOccluder({ -20.f, -20.f, 10.f, 20.f, 20.f, 11.f });
+    culler.Finish();
+
+    EXPECT_TRUE(culler.GetDepth(Scene::OcclusionCuller::width / 2, Scene::OcclusionCuller::height / 2) < 1.f);
+    EXPECT_FALSE(culler.IsVisible({ -1.f, -1.f, 30.f, 1.f, 1.f, 32.f }));
+    EXPECT_TRUE(culler.IsVisible({ -1.f, -1.f, 5.f, 1.f, 1.f, 7.f }));
+}
+
+TEST_F(OcclusionCullerTests, PartialCoverage)
+{
+    culler.AddOccluder({ 0.f, -20.f, 10.f, 20.f, 20.f, 11.f });
+    culler.Finish();
+
+    EXPECT_FALSE(culler.IsVisible({ 10.f, -1.f, 30.f, 12.f, 1.f, 32.f }));
+    EXPECT_TRUE(culler.IsVisible({ -12.f, -1.f, 30.f, -10.f, 1.f, 32.f }));
+    // Half behind the wall, half beside it
+    EXPECT_TRUE(culler.IsVisible({ -4.f, -1.f, 30.f, 4.f, 1.f, 32.f }));
+}
+
+TEST_F(OcclusionCullerTests, BoxBehindCamera)
+{
+    culler.AddOccluder({ -20.f, -20.f, 10.f, 20.f, 20.f, 11.f });
+    culler.Finish();
+
+    EXPECT_TRUE(culler.IsVisible({ -1.f, -1.f, -5.f, 1.f, 1.f, 30.f }));
+}
+
+TEST_F(OcclusionCullerTests, HeightfieldHidesValley)
+{
+    // A ridge across the view at z = 24..40, flat ground in front of it
+    std::array<int32_t, 4> heights = { 0, 10, 0, 10 };
+    culler.Begin(CreateViewProjection(1.2f, 2.f, 0.1f, 1000.f, 5.f), { 0.f, 5.f, 0.f });
+    culler.AddHeightfieldOccluder({ -16, 8 }, 16, 2, heights);
+    culler.Finish();
+
+    EXPECT_FALSE(culler.IsVisible({ -2.f, 0.f, 40.f, 2.f, 2.f, 42.f }));
+    EXPECT_TRUE(culler.IsVisible({ -2.f, 20.f, 40.f, 2.f, 22.f, 42.f }));
+}
+
+TEST_F(OcclusionCullerTests, PyramidReachesSingleTexel)
+{
+    culler.AddOccluder({ -1000.f, -1000.f, 10.f, 1000.f, 1000.f, 11.f });
+    culler.Finish();
+
+    auto levels = culler.GetLevelCount();
+    ASSERT_EQ(levels, 8u);
+    EXPECT_LT(culler.GetMaxDepth(levels - 1, 0, 0), 1.f);
+    EXPECT_FLOAT_EQ(culler.GetMaxDepth(levels - 1, 0, 0), culler.GetMaxDepth(0, 0, 0));
+}
+
+TEST_F(OcclusionCullerTests, LargeBoxBehindWall)
+{
+    // The box covers most of the screen and is tested at a coarse level
+    culler.AddOccluder({ -1000.f, -1000.f, 10.f, 1000.f, 1000.f, 11.f });
+    culler.Finish();
+
+    EXPECT_FALSE(culler.IsVisible({ -200.f, -200.f, 30.f, 200.f, 200.f, 32.f }));
+    EXPECT_TRUE(culler.IsVisible({ -200.f, -200.f, 5.f, 200.f, 200.f, 7.f }));
+}
+
+TEST_F(OcclusionCullerTests, LargeBoxBesideWall)
+{
+    culler.AddOccluder({ 0.f, -1000.f, 10.f, 1000.f, 1000.f, 11.f });
+    culler.Finish();
+
+    EXPECT_FALSE(culler.IsVisible({ 10.f, -40.f, 30.f, 60.f, 40.f, 32.f }));
+    EXPECT_TRUE(culler.IsVisible({ -60.f, -40.f, 30.f, 60.f, 40.f, 32.f }));
+}
@@ -0,0 +1,80 @@
+#include "gtest/gtest.h"
+
+#include "Structures.h"
+
+#include <Noise.h>
+
+using Scene::utils::vec2i;
+
+struct FlatNoise
+    : public INoise
+{
+    int32_t GetHeight(int32_t, int32_t) const override
+    {
+        return 64;
+    }
+
+    bool IsTree(int32_t x, int32_t y) const override
+    {
+        return (x % 16 == 0) && (y % 16 == 0);
+    }
+};
+
+static bool Intersects(const Scene::Structure& structure, const vec2i& chunk)
+{
+    auto size = Scene::g_chunk_size;
+    return structure.bbox.first.x < chunk.x * size + size && structure.bbox.second.x > chunk.x * size
+        && structure.bbox.first.z < chunk.y * size + size && structure.bbox.second.z > chunk.y * size;
+}
+
+TEST(StructuresTests, Deterministic)
+{
+    FlatNoise noise;
+    Scene::StructureCache first(noise, 16);
+    Scene::StructureCache second(noise, 16);
+
+    for (const auto& chunk : { vec2i(0, 0), vec2i(-3, 5), vec2i(7, -1) })
+    {
+        auto a = first.Query(chunk);
+        auto b = second.Query(chunk);
+        ASSERT_EQ(a.size(), b.size());
+        for (size_t i = 0; i < a.size(); ++i)
+            EXPECT_EQ(a[i].origin, b[i].origin);
+    }
+}
+
+TEST(StructuresTests, OnlyIntersecting)
+{
+    FlatNoise noise;
+    Scene::StructureCache cache(noise, 16);
+
+    for (int32_t x = -5; x < 5; ++x)
+    {
+        for (int32_t z = -5; z < 5; ++z)
+        {
+            auto structures = cache.Query({ x, z });
+            EXPECT_FALSE(structures.empty());
+            for (const auto& structure : structures)
+                EXPECT_TRUE(Intersects(structure, { x, z }));
+        }
+    }
+}
+
+TEST(StructuresTests, SharedAcrossBorder)
+{
+    FlatNoise noise;
+    Scene::StructureCache cache(noise, 16);
+
+    // a tree at x = 0 spills into the chunk on its left
+    auto left = cache.Query({ -1, 0 });
+    auto right = cache.Query({ 0, 0 });
+
+    auto has_tree = [](const Scene::Structures& structures, const Scene::Point3D& origin) {
+        return std::any_of(structures.begin(), structures.end(), [&](const auto& structure) {
+            return structure.origin == origin;
+        });
+    };
+    EXPECT_TRUE(has_tree(left, { 0, 64, 16 }));
+    EXPECT_TRUE(has_tree(right, { 0, 64, 16 }));
+    EXPECT_FALSE(has_tree(left, { 16, 64, 16 }));
+}